@@ -0,0 +1,235 @@
+#include "fake_camera.hpp"
+
+#include "alloc_guard.hpp"
+#include "camera.hpp"
+#include "camera_log.hpp"
+#include "config.hpp"
+#include "shared.hpp"
+#include "trig.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace bench {
+
+namespace /* unnamed */ {
+
+auto g_sink = 0.0f;
+
+template <typename Function>
+void measure(string_view name, size_t repetitions, size_t ops_per_repetition, Function&& function) {
+    function(); // warm up caches and the branch predictor
+    auto const start = std::chrono::steady_clock::now();
+    for (auto repetition = size_t {0}; repetition < repetitions; ++repetition) function();
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    auto const ns = std::chrono::duration<double, std::nano> {elapsed}.count();
+    auto const ops = static_cast<double>(repetitions * ops_per_repetition);
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+        << std::setw(12) << ns / ops << " ns/op" << std::setw(14) << static_cast<size_t>(ops) << " ops\n";
+}
+
+void bench_update(std::vector<Frame> const& frames, config::Snapshot const& snapshot) {
+    auto camera = std::make_unique<FakeCamera>();
+    measure("camera::update", 20, frames.size(), [&] {
+        for (auto const& frame : frames) {
+            camera->write(frame.camera_id, frame.params);
+            camera::update(camera->address(), snapshot);
+        }
+        g_sink += camera->read_params().fov;
+    });
+}
+
+void bench_adjust(std::vector<Frame> const& frames, config::Snapshot const& snapshot) {
+    measure("Params::adjust", 20, frames.size(), [&] {
+        for (auto const& frame : frames) {
+            auto const context = camera::get_camera_info(frame.camera_id).context.value_or(camera::Context::Quest);
+            g_sink += frame.params.adjust(context, frame.camera_id, snapshot).fov;
+        }
+    });
+}
+
+// Input FOVs the game sends, including temporary effects, and the FOVs the
+// config accepts
+constexpr auto game_fov_range = Interval { .lower = 1.0f, .upper = 170.0f };
+constexpr auto config_fov_range = config::fov_range;
+constexpr auto contexts = std::to_array({camera::Context::Hub, camera::Context::Room, camera::Context::Quest});
+
+// The FOV as the plugin computed it before the fast kernels, with
+// std::tan/std::atan throughout and no pass-through of an unchanged FOV
+auto reference_fov(float fov, float target_fov, float base_fov) -> float {
+    constexpr auto pi = 3.1415927f;
+    auto const current_proj = std::tan(pi / 360 * fov);
+    auto const base_proj = std::tan(pi / 360 * base_fov);
+    auto const target_proj = std::tan(pi / 360 * target_fov);
+    return std::round(360 / pi * std::atan(target_proj * current_proj / base_proj));
+}
+
+void bench_trig() {
+    auto inputs = std::vector<float> {};
+    for (auto fov = game_fov_range.lower; fov <= game_fov_range.upper; fov += 0.5f) inputs.push_back(fov);
+    measure("std::tan + std::atan", 2000, inputs.size(), [&] {
+        for (auto const fov : inputs) g_sink += std::atan(std::tan(trig::pi / 360 * fov) * 1.25f);
+    });
+    measure("trig::tan + trig::atan", 2000, inputs.size(), [&] {
+        for (auto const fov : inputs) g_sink += trig::atan(trig::tan(trig::pi / 360 * fov) * 1.25f);
+    });
+}
+
+// Compares every whole and half degree input FOV against every whole degree
+// config FOV in each context. When the config FOV equals the base FOV the
+// plugin rounds the input directly instead, so half degree inputs differ
+// from the baseline there; those are listed and counted but don't fail.
+auto verify_trig() -> bool {
+    auto checked = size_t {0};
+    auto mismatches = size_t {0};
+    auto pass_throughs = size_t {0};
+    for (auto target = config_fov_range.lower; target <= config_fov_range.upper; target += 1.0f) {
+        auto config = config::UserConfig {};
+        config.hub_cam.fov = config.room_cam.fov = config.quest_cam.fov = target;
+        auto const snapshot = std::make_unique<config::Snapshot const>(config::Snapshot::from_config(config, 1));
+        for (auto const context : contexts) {
+            for (auto fov = game_fov_range.lower; fov <= game_fov_range.upper; fov += 0.5f) {
+                auto const params = camera::Params { .fov = fov };
+                auto const actual = params.adjust(context, camera::CameraID::Normal, *snapshot).fov;
+                auto const expected = reference_fov(fov, target, camera::base_fov(context));
+                ++checked;
+                if (actual == expected) continue;
+                auto const pass_through = target == camera::base_fov(context) && actual == std::round(fov);
+                ++(pass_through ? pass_throughs : mismatches);
+                std::cout << (pass_through ? "pass-through: " : "mismatch: ") << as_str(context) << " fov " << fov
+                    << " -> " << target << ": " << actual << " instead of " << expected << '\n';
+            }
+        }
+    }
+    std::cout << "verified " << checked << " FOVs, " << mismatches << " mismatches, "
+        << pass_throughs << " known pass-through differences\n";
+    return mismatches == 0;
+}
+
+auto same_bits(camera::Params const& a, camera::Params const& b) -> bool {
+    return std::memcmp(&a, &b, sizeof(camera::Params)) == 0;
+}
+
+// Compares the packed Params code against the scalar reference, bit for bit,
+// for every camera ID in each context.
+auto verify_packed(config::Snapshot const& snapshot) -> bool {
+    constexpr auto lengths = std::to_array({0.0f, 1.0f, 12.5f, 180.0f, 260.0f, 350.5f, 1234.25f, -40.0f});
+    constexpr auto shifts = std::to_array({-50.0f, 0.0f, 12.5f});
+    auto config = snapshot.config;
+    config.disable_room_shift = !config.disable_room_shift;
+    auto const toggled = std::make_unique<config::Snapshot const>(config::Snapshot::from_config(config, 2));
+
+    auto checked = size_t {0};
+    auto mismatches = size_t {0};
+    for (auto const* current : {&snapshot, toggled.get()}) {
+        for (auto const context : contexts) {
+            for (auto id = uint32_t {0}; id <= camera::camera_id_count; ++id) {
+                for (auto fov = game_fov_range.lower; fov <= game_fov_range.upper; fov += 0.5f) {
+                    for (auto const length : lengths) {
+                        auto const params = camera::Params {
+                            .fov = fov,
+                            .distance = length,
+                            .height = length / 2,
+                            .shift = shifts[checked % shifts.size()],
+                        };
+                        auto const camera_id = camera::CameraID {id};
+                        ++checked;
+                        auto const packed = params.adjust(context, camera_id, *current);
+                        if (same_bits(packed, params.adjust_scalar(context, camera_id, *current))) continue;
+                        if (mismatches++ < 10) std::cout << "packed mismatch: camera " << id << " fov " << fov << '\n';
+                    }
+                }
+            }
+        }
+    }
+
+    // Field 0x1c of the view params belongs to the game and must survive.
+    auto memory = std::array<uint32_t, 12> {};
+    auto scalar_memory = std::array<uint32_t, 12> {};
+    for (auto i = uint32_t {0}; i < 1000; ++i) {
+        for (auto j = uint32_t {0}; j < memory.size(); ++j) memory[j] = (i + 1) * 2654435761u ^ j * 40503u;
+        scalar_memory = memory;
+        auto const address = reinterpret_cast<uintptr_t>(memory.data());
+        auto const scalar_address = reinterpret_cast<uintptr_t>(scalar_memory.data());
+        auto const loaded = camera::Params::from_memory(address);
+        ++checked;
+        if (!same_bits(loaded, camera::Params::from_memory_scalar(scalar_address))) ++mismatches;
+        auto const written = camera::Params { .fov = float(i), .distance = i * 0.5f, .height = -float(i), .shift = 3.0f };
+        written.to_memory(address);
+        written.to_memory_scalar(scalar_address);
+        ++checked;
+        if (memory != scalar_memory) ++mismatches;
+    }
+    std::cout << "verified " << checked << " packed operations, " << mismatches << " mismatches\n";
+    return mismatches == 0;
+}
+
+// Runs the frame sequence the way the update hook does, which must not
+// allocate. Debug records are formatted on the log thread, as in the game.
+auto verify_allocations(std::vector<Frame> const& frames, config::Snapshot const& snapshot) -> bool {
+    auto camera = std::make_unique<FakeCamera>();
+    camera_log::start();
+    alloc_guard::configure(true);
+    for (auto const& frame : frames) {
+        camera->write(frame.camera_id, frame.params);
+        auto const guard = alloc_guard::Scope {profiler::Stage::Update};
+        camera::update(camera->address(), snapshot);
+    }
+    alloc_guard::configure(false);
+    camera_log::stop();
+    auto const allocations = alloc_guard::get_counts()[std::to_underlying(profiler::Stage::Update)];
+    std::cout << "verified " << frames.size() << " frames, " << allocations << " allocations\n";
+    return allocations == 0;
+}
+
+void bench_parse(string_view path) {
+    measure("UserConfig::from_file", 200, 1, [&] {
+        auto const config = config::UserConfig::from_file(path);
+        if (config.has_value()) g_sink += config->quest_cam.fov;
+    });
+    config::UserConfig::load(path); // writes the config cache next to the file
+    measure("UserConfig::load, cached", 200, 1, [&] {
+        auto const config = config::UserConfig::load(path);
+        if (config.has_value()) g_sink += config->quest_cam.fov;
+    });
+}
+
+} /* unnamed namespace */
+
+} /* namespace bench */
+
+auto main(int argc, char** argv) -> int {
+    auto const verify = argc > 1 && string_view {argv[1]} == "--verify";
+    if (verify) {
+        --argc;
+        ++argv;
+    }
+    auto const path = std::string {argc > 1 ? argv[1] : "CustomFOV.toml"};
+    auto const config = config::UserConfig::from_file(path);
+    if (!config.has_value()) {
+        std::cerr << "Failed to parse '" << path << "'.\n";
+        return 1;
+    }
+    auto const snapshot = std::make_unique<config::Snapshot const>(config::Snapshot::from_config(*config, 1));
+    if (verify) {
+        auto const trig_ok = bench::verify_trig();
+        auto const packed_ok = bench::verify_packed(*snapshot);
+        auto const allocations_ok = bench::verify_allocations(bench::make_sequence(), *snapshot);
+        return trig_ok && packed_ok && allocations_ok ? 0 : 1;
+    }
+    auto const frames = bench::make_sequence();
+
+    bench::bench_update(frames, *snapshot);
+    bench::bench_adjust(frames, *snapshot);
+    bench::bench_parse(path);
+    bench::bench_trig();
+    std::cout << "checksum " << bench::g_sink << '\n'; // keeps the results alive
+    return 0;
+}
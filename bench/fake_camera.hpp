@@ -0,0 +1,80 @@
+#ifndef MHWORLD_CUSTOM_FOV_BENCH_FAKE_CAMERA_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_BENCH_FAKE_CAMERA_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "camera_id.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bench {
+
+// Just enough of the game's camera object for camera::update.
+struct FakeCamera {
+    alignas(16) std::array<std::byte, 0x1400> memory = {};
+
+    auto address() -> uintptr_t {
+        return reinterpret_cast<uintptr_t>(this->memory.data());
+    }
+
+    void write(camera::CameraID camera_id, camera::Params const& params) {
+        params.to_memory(this->address() + camera::params_offset);
+        std::memcpy(this->memory.data() + camera::camera_id_offset, &camera_id, sizeof(camera_id));
+    }
+
+    auto read_params() -> camera::Params {
+        return camera::Params::from_memory(this->address() + camera::params_offset);
+    }
+};
+
+struct Frame {
+    camera::CameraID camera_id;
+    camera::Params params; // as written by the game, before adjustment
+};
+
+// Walks through a hub, the player room, an expedition and a hunt, with the
+// game interpolating the FOV for a moment after every preset change.
+inline
+auto make_sequence() -> std::vector<Frame> {
+    using camera::CameraID;
+    struct Phase {
+        CameraID camera_id;
+        size_t frames;
+    };
+    constexpr auto phases = std::to_array<Phase>({
+        {CameraID::SelianaHub,       1800},
+        {CameraID::SelianaHubSprint,  300},
+        {CameraID::SelianaHub,        600},
+        {CameraID::SelianaRoom,       900},
+        {CameraID::Normal,           3600},
+        {CameraID::Sprint,            600},
+        {CameraID::Normal,            600},
+        {CameraID::Combat,           7200},
+        {CameraID::Normal,           1200},
+    });
+    constexpr auto interp_frames = size_t {30};
+
+    auto frames = std::vector<Frame> {};
+    auto previous_fov = camera::base_fov(camera::Context::Quest);
+    for (auto const& [camera_id, count] : phases) {
+        auto const context = camera::get_camera_info(camera_id).context.value_or(camera::Context::Quest);
+        auto const target = camera::Params::from_context(context);
+        for (auto frame = size_t {0}; frame < count; ++frame) {
+            auto params = target;
+            if (frame < interp_frames) {
+                auto const t = static_cast<float>(frame) / interp_frames;
+                params.fov = previous_fov + (target.fov - previous_fov) * t;
+            }
+            frames.push_back(Frame { .camera_id = camera_id, .params = params });
+        }
+        previous_fov = target.fov;
+    }
+    return frames;
+}
+
+} /* namespace bench */
+
+#endif /* include guard */
@@ -0,0 +1,17 @@
+// Stand-in for the mod loader's exports, so the plugin sources can be
+// linked into a standalone executable.
+
+#include "loader.h"
+
+#include <iostream>
+
+namespace loader {
+
+const char* GameVersion = "421810";
+LogLevel MinLogLevel = INFO;
+
+LOG::~LOG() {
+    if (this->logLevel >= MinLogLevel) std::clog << this->stream.str() << '\n';
+}
+
+} /* namespace loader */
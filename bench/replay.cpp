@@ -0,0 +1,277 @@
+#include "fake_camera.hpp"
+
+#include "camera.hpp"
+#include "camera_id.hpp"
+#include "config.hpp"
+#include "shared.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace replay {
+
+namespace /* unnamed */ {
+
+// Replays at least this many updates per measurement, looping short traces.
+constexpr auto min_updates = size_t {10'000'000};
+
+using bench::FakeCamera;
+using ParamWords = std::array<uint32_t, trace::param_word_count>;
+
+// The recorded frames in the order they were recorded, with the fake
+// camera and context each one replays in.
+struct Replay {
+    std::vector<trace::Record> records = {};
+    std::vector<std::unique_ptr<FakeCamera>> cameras = {};
+    std::vector<uint32_t> camera_indices = {};
+    std::vector<camera::Context> contexts = {};
+    std::vector<camera::Params> inputs = {};
+};
+
+auto read_records(std::string const& path) -> optional<std::vector<trace::Record>> {
+    auto stream = std::ifstream {path, std::ios::binary};
+    auto header = trace::Header {};
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Failed to read '" << path << "'.\n";
+        return std::nullopt;
+    }
+    if (header.magic != trace::file_magic || header.format != trace::file_format
+        || header.header_size != sizeof(trace::Header) || header.record_size != sizeof(trace::Record)) {
+        std::cerr << "'" << path << "' is not a camera trace of format " << trace::file_format << ".\n";
+        return std::nullopt;
+    }
+    auto const wrapped = header.written > header.capacity;
+    auto records = std::vector<trace::Record>(wrapped ? header.capacity : header.written);
+    auto const size = static_cast<std::streamsize>(records.size() * sizeof(trace::Record));
+    if (!stream.read(reinterpret_cast<char*>(records.data()), size)) {
+        std::cerr << "'" << path << "' is truncated.\n";
+        return std::nullopt;
+    }
+    // A circular trace that wrapped around starts at the oldest record.
+    if (wrapped) std::ranges::rotate(records, records.begin() + header.written % header.capacity);
+    return records;
+}
+
+auto params_from_words(ParamWords const& words) -> camera::Params {
+    auto const fields = reinterpret_cast<uintptr_t>(words.data());
+    return camera::Params::from_memory_scalar(fields - (camera::params_fields_begin - camera::params_offset));
+}
+
+// Gives every recorded camera object a fake one, and follows the context
+// the way camera::update does: a new camera starts in the context of the
+// camera updated last.
+auto make_replay(std::vector<trace::Record> records) -> Replay {
+    auto replay = Replay {};
+    auto indices = std::unordered_map<uint64_t, uint32_t> {};
+    auto camera_contexts = std::vector<camera::Context> {};
+    auto last_context = camera::Context::Quest;
+    for (auto const& record : records) {
+        auto const [it, inserted] = indices.try_emplace(record.camera_address, static_cast<uint32_t>(replay.cameras.size()));
+        if (inserted) {
+            replay.cameras.push_back(std::make_unique<FakeCamera>());
+            camera_contexts.push_back(last_context);
+        }
+        auto& context = camera_contexts[it->second];
+        auto const& info = camera::get_camera_info(camera::CameraID {record.camera_id});
+        if (info.context.has_value()) context = *info.context;
+        last_context = context;
+        replay.camera_indices.push_back(it->second);
+        replay.contexts.push_back(context);
+        replay.inputs.push_back(params_from_words(record.before));
+    }
+    replay.records = std::move(records);
+    return replay;
+}
+
+void write_camera(FakeCamera& camera, trace::Record const& record) {
+    std::memcpy(camera.memory.data() + camera::params_fields_begin, record.before.data(), sizeof(ParamWords));
+    std::memcpy(camera.memory.data() + camera::camera_id_offset, &record.camera_id, sizeof(record.camera_id));
+}
+
+auto read_words(FakeCamera const& camera) -> ParamWords {
+    auto words = ParamWords {};
+    std::memcpy(words.data(), camera.memory.data() + camera::params_fields_begin, sizeof(ParamWords));
+    return words;
+}
+
+void replay_updates(Replay const& replay, config::Snapshot const& snapshot) {
+    for (auto index = size_t {0}; index < replay.records.size(); ++index) {
+        auto& camera = *replay.cameras[replay.camera_indices[index]];
+        write_camera(camera, replay.records[index]);
+        camera::update(camera.address(), snapshot);
+    }
+}
+
+constexpr auto pi = 3.1415927f;
+
+// Params::adjust computed with the standard library from the snapshot's
+// projection scale, for the FOV only. Differences come from the tan/atan
+// kernels alone.
+auto std_trig_fov(camera::Params const& params, camera::Context context, camera::CameraID camera_id,
+                  config::Snapshot const& snapshot) -> float {
+    if (camera::get_camera_info(camera_id).dont_touch) return params.fov;
+    auto const proj_scale = snapshot.get_adjustment(context, camera_id).proj_scale;
+    if (proj_scale == 1.0f) return params.fov;
+    return std::round(360 / pi * std::atan(std::tan(pi / 360 * params.fov) * proj_scale));
+}
+
+// The FOV as the plugin computed it before the fast kernels, from the
+// settings and with std::tan/std::atan throughout, without passing an
+// unchanged FOV through.
+auto plain_fov(camera::Params const& params, camera::Context context, camera::CameraID camera_id,
+               config::Snapshot const& snapshot) -> float {
+    if (camera::get_camera_info(camera_id).dont_touch) return params.fov;
+    auto settings = snapshot.config.get_settings(context);
+    for (auto const& [override_id, override_settings] : snapshot.config.camera_overrides) {
+        if (override_id == camera_id) settings = override_settings.apply(snapshot.config.get_settings(context));
+    }
+    auto const current_proj = std::tan(pi / 360 * params.fov);
+    auto const base_proj = std::tan(pi / 360 * camera::base_fov(context));
+    auto const target_proj = std::tan(pi / 360 * settings.fov);
+    return std::round(360 / pi * std::atan(target_proj * current_proj / base_proj));
+}
+
+struct Mismatches {
+    size_t trace = 0;
+    size_t scalar = 0;
+    size_t std_trig = 0;
+    size_t plain = 0;
+};
+
+auto check(Replay const& replay, config::Snapshot const& snapshot) -> Mismatches {
+    auto mismatches = Mismatches {};
+    for (auto index = size_t {0}; index < replay.records.size(); ++index) {
+        auto const& record = replay.records[index];
+        auto& camera = *replay.cameras[replay.camera_indices[index]];
+        write_camera(camera, record);
+        camera::update(camera.address(), snapshot);
+        if (read_words(camera) != record.after && mismatches.trace++ < 10) {
+            std::cout << "frame " << index << ": camera " << record.camera_id << " differs from the trace\n";
+        }
+
+        auto const camera_id = camera::CameraID {record.camera_id};
+        auto const& input = replay.inputs[index];
+        auto const packed = input.adjust(replay.contexts[index], camera_id, snapshot);
+        auto const scalar = input.adjust_scalar(replay.contexts[index], camera_id, snapshot);
+        if (std::memcmp(&packed, &scalar, sizeof(camera::Params)) != 0) ++mismatches.scalar;
+        if (packed.fov != std_trig_fov(input, replay.contexts[index], camera_id, snapshot)) ++mismatches.std_trig;
+        if (packed.fov != plain_fov(input, replay.contexts[index], camera_id, snapshot)) ++mismatches.plain;
+    }
+    return mismatches;
+}
+
+void report(string_view name, size_t threads, size_t updates, std::chrono::steady_clock::duration elapsed) {
+    auto const seconds = std::chrono::duration<double> {elapsed}.count();
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(3) << threads << " thread(s)"
+        << std::fixed << std::setprecision(2)
+        << std::setw(10) << seconds * 1e9 / updates << " ns/op"
+        << std::setw(10) << updates / seconds / 1e6 << " M updates/s\n";
+}
+
+void measure_updates(Replay const& replay, config::Snapshot const& snapshot) {
+    auto const repetitions = std::max<size_t>(1, min_updates / replay.records.size());
+    replay_updates(replay, snapshot); // warm up
+    auto const start = std::chrono::steady_clock::now();
+    for (auto repetition = size_t {0}; repetition < repetitions; ++repetition) replay_updates(replay, snapshot);
+    report("camera::update", 1, repetitions * replay.records.size(), std::chrono::steady_clock::now() - start);
+}
+
+// Each thread adjusts its own contiguous segment of the trace.
+void measure_adjust(Replay const& replay, config::Snapshot const& snapshot, size_t thread_count) {
+    auto const size = replay.inputs.size();
+    auto const repetitions = std::max<size_t>(1, min_updates / size);
+    auto sinks = std::vector<float>(thread_count);
+    auto const run_segment = [&](size_t thread) {
+        auto const begin = size * thread / thread_count;
+        auto const end = size * (thread + 1) / thread_count;
+        auto sink = 0.0f;
+        for (auto repetition = size_t {0}; repetition < repetitions; ++repetition) {
+            for (auto index = begin; index < end; ++index) {
+                auto const camera_id = camera::CameraID {replay.records[index].camera_id};
+                sink += replay.inputs[index].adjust(replay.contexts[index], camera_id, snapshot).fov;
+            }
+        }
+        sinks[thread] = sink;
+    };
+
+    auto const start = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::thread> {};
+    for (auto thread = size_t {1}; thread < thread_count; ++thread) threads.emplace_back(run_segment, thread);
+    run_segment(0);
+    for (auto& thread : threads) thread.join();
+    report("Params::adjust", thread_count, repetitions * size, std::chrono::steady_clock::now() - start);
+}
+
+} /* unnamed namespace */
+
+} /* namespace replay */
+
+// replay <trace> [config] [--threads N] [--strict]
+//
+// --strict also fails if any FOV differs from the standard library formulas.
+auto main(int argc, char** argv) -> int {
+    auto paths = std::vector<std::string> {};
+    auto thread_count = static_cast<size_t>(std::max<unsigned>(1, std::thread::hardware_concurrency()));
+    auto strict = false;
+    for (auto index = 1; index < argc; ++index) {
+        if (string_view {argv[index]} == "--strict") {
+            strict = true;
+        } else if (string_view {argv[index]} == "--threads" && index + 1 < argc) {
+            thread_count = std::clamp<size_t>(std::strtoul(argv[++index], nullptr, 10), 1, 256);
+        } else {
+            paths.emplace_back(argv[index]);
+        }
+    }
+    if (paths.empty() || paths.size() > 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace> [config] [--threads N] [--strict]\n";
+        return 1;
+    }
+    auto const config_path = paths.size() > 1 ? paths[1] : std::string {"CustomFOV.toml"};
+    auto const config = config::UserConfig::from_file(config_path);
+    if (!config.has_value()) {
+        std::cerr << "Failed to parse '" << config_path << "'.\n";
+        return 1;
+    }
+    auto records = replay::read_records(paths[0]);
+    if (!records.has_value()) return 1;
+    if (records->empty()) {
+        std::cerr << "'" << paths[0] << "' holds no frames.\n";
+        return 1;
+    }
+    auto const snapshot = std::make_unique<config::Snapshot const>(config::Snapshot::from_config(*config, 1));
+    auto const replay = replay::make_replay(std::move(*records));
+
+    auto versions = std::set<uint32_t> {};
+    for (auto const& record : replay.records) versions.insert(record.config_version);
+    std::cout << "replaying " << replay.records.size() << " frames of " << replay.cameras.size() << " camera(s)\n";
+    if (versions.size() > 1) {
+        std::cout << "the config changed " << versions.size() - 1 << " time(s) during the trace, "
+            "only frames recorded with '" << config_path << "' can match\n";
+    }
+
+    auto const mismatches = replay::check(replay, *snapshot);
+    replay::measure_updates(replay, *snapshot);
+    replay::measure_adjust(replay, *snapshot, 1);
+    if (thread_count > 1) replay::measure_adjust(replay, *snapshot, thread_count);
+
+    std::cout << mismatches.trace << " frames differ from the trace\n"
+        << mismatches.scalar << " frames differ between packed and scalar Params::adjust\n"
+        << mismatches.std_trig << " FOVs differ from std::tan/std::atan on the same projection scale\n"
+        << mismatches.plain << " FOVs differ from the plain std::tan/std::atan formula\n";
+    auto const differs_from_std = mismatches.std_trig != 0 || mismatches.plain != 0;
+    return mismatches.trace == 0 && mismatches.scalar == 0 && !(strict && differs_from_std) ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#ifndef MHWORLD_CUSTOM_FOV_API_H_INCLUDED
+#define MHWORLD_CUSTOM_FOV_API_H_INCLUDED
+
+/*
+ * C interface for other plugins that need the camera state, so they don't
+ * have to hook the camera update function themselves. CustomFOV.dll may
+ * load after a dependent, so resolve the functions at runtime with
+ * GetModuleHandleW(L"CustomFOV.dll") and GetProcAddress, and check
+ * CustomFOV_GetApiVersion before using anything else.
+ */
+
+#include <stdint.h>
+
+#if defined(CUSTOMFOV_BUILD)
+#define CUSTOMFOV_API __declspec(dllexport)
+#else
+#define CUSTOMFOV_API __declspec(dllimport)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CUSTOMFOV_API_VERSION 1
+
+#define CUSTOMFOV_CONTEXT_HUB   0
+#define CUSTOMFOV_CONTEXT_ROOM  1
+#define CUSTOMFOV_CONTEXT_QUEST 2
+
+typedef struct CustomFOV_CameraSnapshot {
+    uint64_t frame;             /* camera updates so far, 0 before the first */
+    uint64_t camera_address;    /* the game's camera object */
+    uint32_t context;           /* CUSTOMFOV_CONTEXT_* */
+    uint32_t camera_id;         /* camera preset */
+    uint32_t config_version;    /* incremented on every config reload */
+    uint32_t reserved;
+    float fov;                  /* view params after adjustment */
+    float distance;
+    float height;
+    float shift;
+} CustomFOV_CameraSnapshot;
+
+/*
+ * Runs on the game's camera thread right after CustomFOV adjusted the
+ * camera, and must return quickly. The update hook stays enabled while
+ * any callback is registered.
+ */
+typedef void (*CustomFOV_CameraCallback)(CustomFOV_CameraSnapshot const* snapshot, void* user_data);
+
+CUSTOMFOV_API uint32_t CustomFOV_GetApiVersion(void);
+
+/* Copies the last camera update from any thread. Returns 0 before the first. */
+CUSTOMFOV_API int CustomFOV_GetCameraSnapshot(CustomFOV_CameraSnapshot* snapshot);
+
+/* Returns 0 if all callback slots are taken. */
+CUSTOMFOV_API int CustomFOV_RegisterCameraCallback(CustomFOV_CameraCallback callback, void* user_data);
+
+/*
+ * Returns 0 if the pair was not registered. Once it returns, the callback
+ * is not running and will not run again, unless called from the callback.
+ */
+CUSTOMFOV_API int CustomFOV_UnregisterCameraCallback(CustomFOV_CameraCallback callback, void* user_data);
+
+typedef uint32_t (*CustomFOV_GetApiVersionFn)(void);
+typedef int (*CustomFOV_GetCameraSnapshotFn)(CustomFOV_CameraSnapshot* snapshot);
+typedef int (*CustomFOV_RegisterCameraCallbackFn)(CustomFOV_CameraCallback callback, void* user_data);
+typedef int (*CustomFOV_UnregisterCameraCallbackFn)(CustomFOV_CameraCallback callback, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,71 @@
+#include "address_cache.hpp"
+
+#include "config.hpp"
+#include "scanner.hpp"
+#include "shared.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace address_cache {
+
+namespace /* unnamed */ {
+
+constexpr auto file_magic = uint32_t {0x43464f56}; // "CFOV"
+constexpr auto file_format = uint32_t {1};
+
+struct File {
+    uint32_t magic = file_magic;
+    uint32_t format = file_format;
+    Entry entry = {};
+};
+
+auto get_cache_path() -> optional<std::filesystem::path> {
+    auto const config_path = config::get_config_path();
+    if (!config_path.has_value()) return std::nullopt;
+    return std::filesystem::path {*config_path}.replace_extension(".cache");
+}
+
+} /* unnamed namespace */
+
+auto current_identity() -> optional<ModuleIdentity> {
+    auto const headers = scanner::main_module_headers();
+    if (headers == nullptr) return std::nullopt;
+    auto identity = ModuleIdentity {
+        .time_date_stamp = headers->FileHeader.TimeDateStamp,
+        .size_of_image = headers->OptionalHeader.SizeOfImage,
+        .checksum = headers->OptionalHeader.CheckSum,
+    };
+    auto const game_version = string_view {GameVersion};
+    std::ranges::copy(game_version.substr(0, identity.game_version.size() - 1), identity.game_version.begin());
+    return identity;
+}
+
+auto load() -> optional<Entry> {
+    auto const path = get_cache_path();
+    auto const identity = current_identity();
+    if (!path.has_value() || !identity.has_value()) return std::nullopt;
+
+    auto stream = std::ifstream {*path, std::ios::binary};
+    auto file = File {};
+    if (!stream.read(reinterpret_cast<char*>(&file), sizeof(file))) return std::nullopt;
+    if (file.magic != file_magic || file.format != file_format) return std::nullopt;
+    if (file.entry.identity != *identity) {
+        LOGLINE(DEBUG) << "Address cache was written for a different game build.";
+        return std::nullopt;
+    }
+    return file.entry;
+}
+
+void store(Entry const& entry) {
+    auto const path = get_cache_path();
+    if (!path.has_value()) return;
+    auto const file = File { .entry = entry };
+    auto stream = std::ofstream {*path, std::ios::binary | std::ios::trunc};
+    if (!stream.write(reinterpret_cast<char const*>(&file), sizeof(file))) {
+        LOGLINE(WARN) << "Failed to write address cache '" << path->string() << "'.";
+    }
+}
+
+} /* namespace address_cache */
@@ -0,0 +1,41 @@
+#ifndef MHWORLD_CUSTOM_FOV_ADDRESS_CACHE_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_ADDRESS_CACHE_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace address_cache {
+
+// Cheap to read from the loaded image, and changes with every game patch.
+struct ModuleIdentity {
+    uint32_t time_date_stamp = 0;
+    uint32_t size_of_image = 0;
+    uint32_t checksum = 0;
+    std::array<char, 16> game_version = {};
+
+    auto operator==(ModuleIdentity const&) const -> bool = default;
+};
+
+// Everything resolved for one build of the game. Addresses are stored
+// relative to the image base.
+struct Entry {
+    ModuleIdentity identity = {};
+    uint64_t init_camera_rva = 0;
+    uint64_t update_camera_rva = 0;
+    uint32_t params_offset = 0;
+    uint32_t camera_id_offset = 0;
+    double last_scan_ms = 0.0;
+};
+
+auto current_identity() -> optional<ModuleIdentity>;
+
+// Returns the cached entry if it was written for the running executable.
+// The caller still has to validate the addresses.
+auto load() -> optional<Entry>;
+void store(Entry const& entry);
+
+} /* namespace address_cache */
+
+#endif /* include guard */
@@ -0,0 +1,95 @@
+#include "alloc_guard.hpp"
+
+#include "profiler.hpp"
+#include "shared.hpp"
+
+#include <malloc.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace alloc_guard {
+
+namespace /* unnamed */ {
+
+constexpr auto no_stage = -1;
+
+// Per thread, so that counting in operator new needs no synchronization.
+thread_local auto t_stage = no_stage;
+thread_local auto t_allocations = std::array<uint64_t, profiler::stage_count> {};
+
+auto g_counts = std::array<std::atomic<uint64_t>, profiler::stage_count> {};
+auto g_reported = std::array<std::atomic<bool>, profiler::stage_count> {};
+
+void count_allocation() {
+    if (t_stage != no_stage) ++t_allocations[t_stage];
+}
+
+void report(profiler::Stage stage, uint64_t allocations) {
+    auto const index = std::to_underlying(stage);
+    g_counts[index].fetch_add(allocations, std::memory_order_relaxed);
+    if (g_reported[index].exchange(true)) return;
+    // Logging allocates as well, which must not count towards an outer scope.
+    auto const stage_before = std::exchange(t_stage, no_stage);
+    LOGLINE(WARN) << allocations << " heap allocation(s) in the " << as_str(stage)
+        << " stage of a camera hook. Further ones in this stage are only counted.";
+    t_stage = stage_before;
+}
+
+} /* unnamed namespace */
+
+void configure(bool enabled) {
+    if (enabled != is_enabled()) LOGLINE(INFO) << "Allocation checks " << (enabled ? "enabled." : "disabled.");
+    hot::g_hook.check_allocations.store(enabled, std::memory_order_relaxed);
+}
+
+auto get_counts() -> std::array<uint64_t, profiler::stage_count> {
+    auto counts = std::array<uint64_t, profiler::stage_count> {};
+    for (auto i = size_t {0}; i < counts.size(); ++i) counts[i] = g_counts[i].load(std::memory_order_relaxed);
+    return counts;
+}
+
+Scope::Scope(profiler::Stage stage) : stage(stage), previous_stage(no_stage), start(0), active(is_enabled()) {
+    if (!this->active) [[likely]] return;
+    auto const index = std::to_underlying(stage);
+    this->previous_stage = std::exchange(t_stage, static_cast<int>(index));
+    this->start = t_allocations[index];
+}
+
+Scope::~Scope() {
+    if (!this->active) [[likely]] return;
+    t_stage = this->previous_stage;
+    auto const allocations = t_allocations[std::to_underlying(this->stage)] - this->start;
+    if (allocations != 0 && !this->dismissed) report(this->stage, allocations);
+}
+
+void Scope::dismiss() {
+    this->dismissed = true;
+}
+
+} /* namespace alloc_guard */
+
+// Replacing these covers all of the plugin's own allocations: the array,
+// nothrow and sized forms of the standard library forward to them.
+auto operator new(size_t size) -> void* {
+    alloc_guard::count_allocation();
+    if (auto const memory = std::malloc(size != 0 ? size : 1)) return memory;
+    throw std::bad_alloc {};
+}
+
+auto operator new(size_t size, std::align_val_t alignment) -> void* {
+    alloc_guard::count_allocation();
+    if (auto const memory = _aligned_malloc(size != 0 ? size : 1, static_cast<size_t>(alignment))) return memory;
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    _aligned_free(memory);
+}
@@ -0,0 +1,51 @@
+#ifndef MHWORLD_CUSTOM_FOV_ALLOC_GUARD_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_ALLOC_GUARD_HPP_INCLUDED
+
+#include "hot_state.hpp"
+#include "profiler.hpp"
+#include "shared.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace alloc_guard {
+
+// Counts heap allocations the plugin makes through operator new on the
+// current thread inside a Scope, and warns once per stage when one happens.
+// The camera hooks are expected to never allocate in steady state.
+
+inline
+auto is_enabled() -> bool {
+    return hot::g_hook.check_allocations.load(std::memory_order_relaxed);
+}
+
+void configure(bool enabled);
+
+// Allocations seen inside each stage since the plugin was loaded.
+auto get_counts() -> std::array<uint64_t, profiler::stage_count>;
+
+// Costs a single relaxed load while the guard is disabled.
+class Scope {
+public:
+    explicit Scope(profiler::Stage stage);
+    ~Scope();
+    Scope(Scope const&) = delete;
+    auto operator=(Scope const&) -> Scope& = delete;
+
+    // Allocations in this scope are expected, e.g. because a new config
+    // was just loaded.
+    void dismiss();
+
+private:
+    profiler::Stage stage;
+    int previous_stage;
+    uint64_t start;
+    bool active;
+    bool dismissed = false;
+};
+
+} /* namespace alloc_guard */
+
+#endif /* include guard */
@@ -0,0 +1,194 @@
+#define CUSTOMFOV_BUILD
+#include "api.hpp"
+
+#include "camera.hpp"
+#include "CustomFOV.h"
+#include "shared.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace api {
+
+namespace /* unnamed */ {
+
+constexpr auto max_callbacks = size_t {8};
+constexpr auto snapshot_words = sizeof(CustomFOV_CameraSnapshot) / sizeof(uint64_t);
+static_assert(sizeof(CustomFOV_CameraSnapshot) == 48);
+static_assert(offsetof(CustomFOV_CameraSnapshot, context) == 16 && offsetof(CustomFOV_CameraSnapshot, fov) == 32);
+
+using Words = std::array<uint64_t, snapshot_words>;
+
+// The snapshot is packed straight into words, since reading back a struct
+// just written field by field would stall on store forwarding.
+constexpr auto pack(uint32_t low, uint32_t high) -> uint64_t {
+    return uint64_t {high} << 32 | low;
+}
+
+auto pack(float low, float high) -> uint64_t {
+    return pack(std::bit_cast<uint32_t>(low), std::bit_cast<uint32_t>(high));
+}
+
+auto unpack(Words const& words) -> CustomFOV_CameraSnapshot {
+    auto snapshot = CustomFOV_CameraSnapshot {};
+    std::memcpy(&snapshot, words.data(), sizeof(snapshot));
+    return snapshot;
+}
+
+// The last snapshot as relaxed atomic words behind a sequence number, so
+// other threads can copy it without a lock.
+struct alignas(cache_line_size) SharedSnapshot {
+    std::atomic<uint32_t> sequence = 0;
+    std::array<std::atomic<uint64_t>, snapshot_words> words = {};
+};
+
+// A slot is rewritten under an odd generation, so the hook can tell when
+// the function and user data it loaded belong to different registrations.
+struct Callback {
+    std::atomic<uint32_t> generation = 0;
+    std::atomic<CustomFOV_CameraCallback> function = nullptr;
+    std::atomic<void*> user_data = nullptr;
+
+    void write(CustomFOV_CameraCallback new_function, void* new_user_data) {
+        auto const current = this->generation.load(std::memory_order_relaxed);
+        this->generation.store(current + 1);
+        this->user_data.store(new_user_data);
+        this->function.store(new_function);
+        this->generation.store(current + 2);
+    }
+
+    auto read() const -> std::pair<CustomFOV_CameraCallback, void*> {
+        while (true) {
+            auto const current = this->generation.load();
+            if (current % 2 != 0) {
+                YieldProcessor();
+                continue;
+            }
+            auto const loaded = std::pair {this->function.load(), this->user_data.load()};
+            if (this->generation.load() == current) return loaded;
+        }
+    }
+};
+
+// Only used by the camera hook thread
+struct alignas(cache_line_size) LastSnapshot {
+    uint64_t frames = 0;
+    Words words = {};
+};
+
+// Registration is serialized by the mutex. The hook marks itself as
+// dispatching before it looks at the callbacks, so unregistering can wait
+// for a callback that is still running.
+struct alignas(cache_line_size) Dispatch {
+    std::atomic<uint32_t> callback_count = 0;
+    std::atomic<bool> dispatching = false;
+};
+
+auto g_shared = SharedSnapshot {};
+auto g_last = LastSnapshot {};
+auto g_dispatch = Dispatch {};
+auto g_callbacks = std::array<Callback, max_callbacks> {};
+auto g_registry_mutex = std::mutex {};
+thread_local auto t_dispatching = false;
+
+auto read_shared() -> CustomFOV_CameraSnapshot {
+    auto words = Words {};
+    while (true) {
+        auto const sequence = g_shared.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 != 0) {
+            YieldProcessor();
+            continue;
+        }
+        for (auto i = size_t {0}; i < snapshot_words; ++i) words[i] = g_shared.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (g_shared.sequence.load(std::memory_order_relaxed) == sequence) break;
+    }
+    return unpack(words);
+}
+
+} /* unnamed namespace */
+
+void publish(uintptr_t camera_address, camera::Context context, camera::CameraID camera_id,
+             camera::Params const& output, uint32_t config_version) {
+    g_last.words = Words {
+        ++g_last.frames,
+        camera_address,
+        pack(static_cast<uint32_t>(context), std::to_underlying(camera_id)),
+        pack(config_version, uint32_t {0}),
+        pack(output.fov, output.distance),
+        pack(output.height, output.shift),
+    };
+    auto const sequence = g_shared.sequence.load(std::memory_order_relaxed);
+    g_shared.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (auto i = size_t {0}; i < snapshot_words; ++i) g_shared.words[i].store(g_last.words[i], std::memory_order_relaxed);
+    g_shared.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto has_callbacks() -> bool {
+    return g_dispatch.callback_count.load(std::memory_order_relaxed) != 0;
+}
+
+void dispatch() {
+    if (!has_callbacks()) [[likely]] return;
+    auto const snapshot = unpack(g_last.words);
+    g_dispatch.dispatching.store(true);
+    t_dispatching = true;
+    for (auto const& callback : g_callbacks) {
+        auto const [function, user_data] = callback.read();
+        if (function != nullptr) function(&snapshot, user_data);
+    }
+    t_dispatching = false;
+    g_dispatch.dispatching.store(false, std::memory_order_release);
+}
+
+} /* namespace api */
+
+extern "C" {
+
+CUSTOMFOV_API uint32_t CustomFOV_GetApiVersion(void) {
+    return CUSTOMFOV_API_VERSION;
+}
+
+CUSTOMFOV_API int CustomFOV_GetCameraSnapshot(CustomFOV_CameraSnapshot* snapshot) {
+    if (snapshot == nullptr) return 0;
+    *snapshot = api::read_shared();
+    return snapshot->frame != 0;
+}
+
+CUSTOMFOV_API int CustomFOV_RegisterCameraCallback(CustomFOV_CameraCallback callback, void* user_data) {
+    if (callback == nullptr) return 0;
+    auto const lock = std::scoped_lock {api::g_registry_mutex};
+    for (auto& slot : api::g_callbacks) {
+        if (slot.function.load() != nullptr) continue;
+        slot.write(callback, user_data);
+        api::g_dispatch.callback_count.fetch_add(1);
+        return 1;
+    }
+    LOGLINE(WARN) << "No free slot for another camera callback.";
+    return 0;
+}
+
+CUSTOMFOV_API int CustomFOV_UnregisterCameraCallback(CustomFOV_CameraCallback callback, void* user_data) {
+    if (callback == nullptr) return 0;
+    {
+        auto const lock = std::scoped_lock {api::g_registry_mutex};
+        auto const slot = std::ranges::find_if(api::g_callbacks, [&](api::Callback const& slot) {
+            return slot.function.load() == callback && slot.user_data.load() == user_data;
+        });
+        if (slot == api::g_callbacks.end()) return 0;
+        slot->write(nullptr, nullptr);
+        api::g_dispatch.callback_count.fetch_sub(1);
+    }
+    // Without the lock, since the running callback may register another one.
+    while (!api::t_dispatching && api::g_dispatch.dispatching.load()) YieldProcessor();
+    return 1;
+}
+
+} /* extern "C" */
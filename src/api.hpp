@@ -0,0 +1,26 @@
+#ifndef MHWORLD_CUSTOM_FOV_API_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_API_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "shared.hpp"
+
+#include <cstdint>
+
+namespace api {
+
+// Producer side of the exported camera snapshot API in CustomFOV.h
+
+// Only call from the camera hook thread.
+void publish(uintptr_t camera_address, camera::Context context, camera::CameraID camera_id,
+             camera::Params const& output, uint32_t config_version);
+
+auto has_callbacks() -> bool;
+
+// Runs the registered callbacks with the last published snapshot. Only
+// call from the camera hook thread, outside of allocation checks, since
+// callbacks belong to other plugins.
+void dispatch();
+
+} /* namespace api */
+
+#endif /* include guard */
@@ -1,12 +1,22 @@
 #include "camera.hpp"
 
+#include "api.hpp"
+#include "camera_id.hpp"
+#include "camera_log.hpp"
 #include "config.hpp"
+#include "hot_state.hpp"
+#include "profiler.hpp"
 #include "shared.hpp"
+#include "telemetry.hpp"
+#include "trig.hpp"
+#include "watchdog.hpp"
+
+#include <intrin.h>
+#include <smmintrin.h>
 
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <iomanip>
 
 auto as_str(camera::Context context) -> string_view {
     switch (context) {
@@ -21,107 +31,28 @@ namespace camera {
 
 namespace /* unnamed */ {
 
-enum class CameraID : uint32_t {
-    Normal              =   0,
-    Sprint              =   3,
-
-    Combat              =  83,
-
-    BaseHub             =  85,
-    BaseHubSprint       =  86,
-
-    LivingQuarters      = 118,
-    PrivateQuarters     = 119,
-    PrivateSuite        = 120,
-
-    SurveyorSet         = 147,
-
-    Seliana             = 252,
-    SelianaSprint       = 253,
-    SelianaHub          = 254,
-    SelianaHubSprint    = 255,
-    SelianaRoom         = 256,
-};
-
-auto operator<<(LOG &log, CameraID param_id) -> LOG& {
-    log << static_cast<int>(param_id);
-    return log;
-}
-
-
-constexpr
-auto sets_hub_context(CameraID id) -> bool {
-    constexpr auto set_hub_context_ids = std::to_array({
-        CameraID::BaseHub,
-        CameraID::BaseHubSprint,
-        CameraID::Seliana,
-        CameraID::SelianaSprint,
-        CameraID::SelianaHub,
-        CameraID::SelianaHubSprint,
-    });
-    return std::ranges::contains(set_hub_context_ids, id);
-}
-
-constexpr
-auto sets_room_context(CameraID id) -> bool {
-    constexpr auto set_room_context_ids = std::to_array({
-        CameraID::LivingQuarters,
-        CameraID::PrivateQuarters,
-        CameraID::PrivateSuite,
-        CameraID::SelianaRoom,
-    });
-    return std::ranges::contains(set_room_context_ids, id);
-}
-
-constexpr
-auto sets_quest_context(CameraID id) -> bool {
-    constexpr auto set_quest_context_ids = std::to_array({
-        CameraID::Normal,
-        CameraID::Sprint,
-        CameraID::Combat,
-    });
-    return std::ranges::contains(set_quest_context_ids, id);
-}
-
 struct State {
     Context context = Context::Quest;
     CameraID camera_id = CameraID::Normal;
 
-    auto update(CameraID new_camera_id) -> State const&;
-};
+    auto operator==(State const&) const -> bool = default;
 
-auto g_state = State {};
+    // Returns true if the context or camera ID changed.
+    auto update(CameraID new_camera_id) -> bool;
+};
 
-auto State::update(CameraID new_camera_id) -> State const& {
-    if (sets_hub_context(new_camera_id)) this->context = Context::Hub;
-    if (sets_room_context(new_camera_id)) this->context = Context::Room;
-    if (sets_quest_context(new_camera_id)) this->context = Context::Quest;
+auto State::update(CameraID new_camera_id) -> bool {
+    auto const previous = *this;
+    auto const& info = get_camera_info(new_camera_id);
+    if (info.context.has_value()) this->context = *info.context;
     this->camera_id = new_camera_id;
-    return g_state;
-}
-
-constexpr auto PI = 3.1415927f;
-
-auto proj_scale_from_fov(float fov) -> float {
-    return std::tan(PI / 360 * fov);
+    return *this != previous;
 }
 
 auto fov_from_proj_scale(float proj_scale) -> float {
-    return 360 / PI * std::atan(proj_scale);
+    return 360 / trig::pi * trig::atan(proj_scale);
 }
 
-struct Params {
-    float fov      =  53.0f;
-    float distance = 380.0f;
-    float height   = 180.0f;
-    float shift    =   0.0f;
-
-    static auto from_context(Context context) -> Params;
-    static auto from_memory(uintptr_t view_params) -> Params;
-    void to_memory(uintptr_t view_params) const;
-    auto adjust(State const& state) const -> Params;
-};
-
 constexpr auto default_hub_params = Params {
     .fov      =  53.0f,
     .distance = 350.0f,
@@ -143,6 +74,8 @@ constexpr auto default_quest_params = Params {
     .shift    =   0.0f,
 };
 
+} /* unnamed namespace */
+
 auto Params::from_context(Context context) -> Params {
     switch (context) {
         case Context::Hub: return default_hub_params;
@@ -152,7 +85,74 @@ auto Params::from_context(Context context) -> Params {
     return {};
 }
 
+namespace /* unnamed */ {
+
+// Offsets within the view params
+constexpr auto block_offset = uintptr_t {0x10}; // shift, height, -distance
+constexpr auto distance_offset = uintptr_t {0x18};
+constexpr auto fov_offset = uintptr_t {0x20};
+
+// Rounds halfway cases away from zero like std::round, which _mm_round_ps
+// cannot do directly.
+auto round_half_away(__m128 value) -> __m128 {
+    auto const sign = _mm_and_ps(value, _mm_set1_ps(-0.0f));
+    auto const half = _mm_or_ps(_mm_set1_ps(0.49999997f), sign);
+    return _mm_round_ps(_mm_add_ps(value, half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+}
+
+auto load(Params const& params) -> __m128 {
+    return _mm_loadu_ps(&params.fov);
+}
+
+auto store(__m128 packed) -> Params {
+    auto params = Params {};
+    _mm_storeu_ps(&params.fov, packed);
+    return params;
+}
+
+} /* unnamed namespace */
+
 auto Params::from_memory(uintptr_t view_params) -> Params {
+    // One load covers shift, height and distance, plus a field we ignore.
+    auto const block = _mm_loadu_ps(reinterpret_cast<float const*>(view_params + block_offset));
+    auto const reversed = _mm_shuffle_ps(block, block, _MM_SHUFFLE(0, 1, 2, 3));
+    auto const fields = _mm_xor_ps(reversed, _mm_setr_ps(0.0f, -0.0f, 0.0f, 0.0f));
+    auto const fov = _mm_load_ss(reinterpret_cast<float const*>(view_params + fov_offset));
+    return store(_mm_move_ss(fields, fov));
+}
+
+void Params::to_memory(uintptr_t view_params) const {
+    auto const packed = load(*this);
+    auto const reversed = _mm_shuffle_ps(packed, packed, _MM_SHUFFLE(0, 1, 2, 3));
+    auto const block = _mm_xor_ps(reversed, _mm_setr_ps(0.0f, 0.0f, -0.0f, 0.0f));
+    // The field after distance belongs to the game, so the block is stored
+    // as shift and height, then distance, leaving it untouched.
+    _mm_storel_pi(reinterpret_cast<__m64*>(view_params + block_offset), block);
+    _mm_store_ss(reinterpret_cast<float*>(view_params + distance_offset), _mm_movehl_ps(block, block));
+    _mm_store_ss(reinterpret_cast<float*>(view_params + fov_offset), packed);
+}
+
+auto Params::adjust(Context context, CameraID camera_id, config::Snapshot const& snapshot) const -> Params {
+    auto const& info = get_camera_info(camera_id);
+    if (info.dont_touch) return *this; // e.g. surveyor set view
+    auto const& adjustment = snapshot.get_adjustment(context, camera_id);
+
+    // An unchanged FOV is passed through exactly, since half degree inputs
+    // would otherwise round either way.
+    auto const adjusted_fov = adjustment.proj_scale == 1.0f
+        ? this->fov
+        : fov_from_proj_scale(proj_scale_from_fov(this->fov) * adjustment.proj_scale);
+
+    // Lanes are fov, distance, height and shift. The FOV is already scaled,
+    // and the shift is kept or cleared but never rounded.
+    auto const input = load(*this);
+    auto const scale = _mm_loadu_ps(&adjustment.proj_scale);
+    auto const scaled = _mm_mul_ps(_mm_move_ss(input, _mm_set_ss(adjusted_fov)), _mm_move_ss(scale, _mm_set_ss(1.0f)));
+    auto const shift = _mm_and_ps(input, _mm_cmpneq_ps(scale, _mm_setzero_ps()));
+    return store(_mm_blend_ps(round_half_away(scaled), shift, 0b1000));
+}
+
+auto Params::from_memory_scalar(uintptr_t view_params) -> Params {
     auto params = Params {};
     params.fov      =  *reinterpret_cast<float*>(view_params + 0x20);
     params.distance = -*reinterpret_cast<float*>(view_params + 0x18);
@@ -161,58 +161,202 @@ auto Params::from_memory(uintptr_t view_params) -> Params {
     return params;
 }
 
-void Params::to_memory(uintptr_t view_params) const {
+void Params::to_memory_scalar(uintptr_t view_params) const {
     *reinterpret_cast<float*>(view_params + 0x20) =  this->fov;
     *reinterpret_cast<float*>(view_params + 0x18) = -this->distance;
     *reinterpret_cast<float*>(view_params + 0x14) =  this->height;
     *reinterpret_cast<float*>(view_params + 0x10) =  this->shift;
 }
 
-auto Params::adjust(State const& state) const -> Params {
-    if (state.camera_id == CameraID::SurveyorSet) return *this; // don't touch surveyor set view
-    auto const &config = config::get_config();
-    auto const &settings = config.get_settings(state.context);
-    auto const base_params = Params::from_context(state.context);
+auto Params::adjust_scalar(Context context, CameraID camera_id, config::Snapshot const& snapshot) const -> Params {
+    auto const& info = get_camera_info(camera_id);
+    if (info.dont_touch) return *this;
+    auto const& adjustment = snapshot.get_adjustment(context, camera_id);
 
-    auto const current_proj = proj_scale_from_fov(this->fov);
-    auto const base_proj = proj_scale_from_fov(base_params.fov);
-    auto const target_proj = proj_scale_from_fov(settings.fov);
-    auto const adjusted_fov = fov_from_proj_scale(target_proj * current_proj / base_proj);
-
-    auto const disable_shift = config.disable_room_shift && sets_room_context(state.camera_id);
+    auto const adjusted_fov = adjustment.proj_scale == 1.0f
+        ? this->fov
+        : fov_from_proj_scale(proj_scale_from_fov(this->fov) * adjustment.proj_scale);
 
     return Params {
         .fov = std::round(adjusted_fov),
-        .distance = std::round(this->distance * settings.distance),
-        .height = std::round(this->height * settings.height),
-        .shift = disable_shift ? 0.0f : this->shift,
+        .distance = std::round(this->distance * adjustment.distance),
+        .height = std::round(this->height * adjustment.height),
+        .shift = adjustment.shift == 0.0f ? 0.0f : this->shift,
     };
 }
 
+namespace /* unnamed */ {
+
+// The game may drive several camera objects through the update function
+// (cutscenes, photo mode, menu previews), so each one gets a slot of its own
+// in a small open addressing table. A slot fills one cache line and also
+// remembers the last adjustment, since most frames adjust the same input
+// params with the same config as the previous one.
+struct alignas(cache_line_size) Slot {
+    uintptr_t camera_address = 0; // 0 for a free slot
+    uint64_t last_used = 0;
+    State state = {};
+
+    // Memoized adjustment, only valid for the current state
+    uint32_t config_version = 0;
+    bool valid = false;
+    Params input = {};
+    Params output = {};
+
+    auto adjust(config::Snapshot const& snapshot, Params const& input) -> Params const&;
+};
+
+static_assert(sizeof(Slot) == cache_line_size);
+
+constexpr auto slot_bits = 3;
+constexpr auto slot_count = size_t {1} << slot_bits;
+
+// Full tables evict the least recently used camera. No slot is ever freed,
+// so a probe can stop at the first free slot.
+class CameraTable {
+public:
+    auto find_or_insert(uintptr_t camera_address) -> Slot&;
+
+private:
+    std::array<Slot, slot_count> slots = {};
+    uint64_t clock = 0;
+    Slot const* most_recent = nullptr;
+};
+
+auto g_cameras = CameraTable {};
+
+auto home_slot(uintptr_t camera_address) -> size_t {
+    // Fibonacci hashing; the low bits of heap addresses carry little entropy.
+    return (camera_address >> 4) * 0x9E3779B97F4A7C15ull >> (64 - slot_bits);
+}
+
+auto CameraTable::find_or_insert(uintptr_t camera_address) -> Slot& {
+    auto const now = ++this->clock;
+    auto const home = home_slot(camera_address);
+    auto* slot = static_cast<Slot*>(nullptr);
+    for (auto probe = size_t {0}; probe < slot_count; ++probe) {
+        auto& candidate = this->slots[(home + probe) % slot_count];
+        if (candidate.camera_address == camera_address) [[likely]] {
+            candidate.last_used = now;
+            this->most_recent = &candidate;
+            return candidate;
+        }
+        if (candidate.camera_address == 0) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        slot = std::ranges::min_element(this->slots, {}, &Slot::last_used);
+        hot::g_hook.evicted_cameras.add();
+    }
+    // A new camera object, e.g. after the previous one was reallocated, starts
+    // in the context of the camera seen last.
+    auto const state = this->most_recent != nullptr ? this->most_recent->state : State {};
+    *slot = Slot { .camera_address = camera_address, .last_used = now, .state = state };
+    this->most_recent = slot;
+    return *slot;
+}
+
+auto Slot::adjust(config::Snapshot const& snapshot, Params const& input) -> Params const& {
+    auto const hit = this->valid
+        && this->config_version == snapshot.version
+        && this->input == input;
+    if (hit) [[likely]] {
+        hot::g_hook.memo_hits.add();
+        return this->output;
+    }
+    hot::g_hook.memo_misses.add();
+    this->config_version = snapshot.version;
+    this->valid = true;
+    this->input = input;
+    this->output = input.adjust(this->state.context, this->state.camera_id, snapshot);
+    return this->output;
+}
+
+struct LoggedAdjustment {
+    Context context;
+    CameraID camera_id;
+    Params output;
+
+    auto operator==(LoggedAdjustment const&) const -> bool = default;
+};
+
+auto g_last_logged = optional<LoggedAdjustment> {};
+auto g_repeated_frames = uint64_t {0};
+
 void log_adjustment(State const& state, Params const& current_params, Params const& new_params) {
-    auto line = std::stringstream {};
-    auto log_param_adjustment = [&](string_view name, float old_value, float new_value) {
-        if (!line.view().empty()) line << ", ";
-        line << name << ' '  << std::fixed << std::setprecision(0) << old_value;
-        if (old_value != new_value) line << " > " << std::setprecision(0) << new_value;
-    };
-    log_param_adjustment("fov", current_params.fov, new_params.fov);
-    log_param_adjustment("distance", current_params.distance, new_params.distance);
-    log_param_adjustment("height", current_params.height, new_params.height);
-    log_param_adjustment("shift", current_params.shift, new_params.shift);
-    LOGLINE(DEBUG) << as_str(state.context) << ' ' << std::setw(3) << state.camera_id << ' ' << line.view();
+    if (MinLogLevel > DEBUG || watchdog::sheds(watchdog::Level::NoDebugLog)) [[likely]] return;
+
+    auto const logged = LoggedAdjustment { state.context, state.camera_id, new_params };
+    if (g_last_logged == logged) {
+        ++g_repeated_frames;
+        return;
+    }
+    camera_log::write(camera_log::Record {
+        .timestamp = query_performance_counter(),
+        .repeated_frames = g_repeated_frames,
+        .context = state.context,
+        .camera_id = state.camera_id,
+        .old_params = current_params,
+        .new_params = new_params,
+    });
+    g_last_logged = logged;
+    g_repeated_frames = 0;
 }
 
 } /* unnamed namespace */
 
-void update(uintptr_t camera_address) {
-    auto const param_address = camera_address + 0x5d0;
+auto base_fov(Context context) -> float {
+    return Params::from_context(context).fov;
+}
+
+auto proj_scale_from_fov(float fov) -> float {
+    return trig::tan(trig::pi / 360 * fov);
+}
+
+auto update(uintptr_t camera_address, config::Snapshot const& snapshot) -> bool {
+    auto const start = telemetry::is_enabled() ? __rdtsc() : 0;
+    auto const param_address = camera_address + params_offset;
     auto const current_params = Params::from_memory(param_address);
-    auto const camera_id = *reinterpret_cast<CameraID*>(camera_address + 0x13b8);
-    auto const& state = g_state.update(camera_id);
-    auto const new_params = current_params.adjust(state);
-    log_adjustment(state, current_params, new_params);
+    auto const camera_id = *reinterpret_cast<CameraID*>(camera_address + camera_id_offset);
+    auto& slot = g_cameras.find_or_insert(camera_address);
+    if (slot.state.update(camera_id)) slot.valid = false;
+    auto const new_params = slot.adjust(snapshot, current_params);
+    log_adjustment(slot.state, current_params, new_params);
+    api::publish(camera_address, slot.state.context, camera_id, new_params, snapshot.version);
+    auto const skip = new_params == current_params;
+    if (skip) hot::g_hook.skipped_stores.add(); // avoid dirtying a cache line the render thread reads
+    if (start != 0) {
+        telemetry::write(telemetry::Frame {
+            .context = slot.state.context,
+            .camera_id = camera_id,
+            .input = current_params,
+            .output = new_params,
+            .config_version = snapshot.version,
+            .stored = !skip,
+            .ticks = __rdtsc() - start,
+        });
+    }
+    if (skip) return false;
+    auto const profile = profiler::Scope {profiler::Stage::Store};
     new_params.to_memory(param_address);
+    return true;
+}
+
+void flush_log() {
+    if (g_repeated_frames == 0) return;
+    LOGLINE(DEBUG) << "(repeated " << g_repeated_frames << " frames)";
+    g_repeated_frames = 0;
+}
+
+auto get_stats() -> Stats {
+    return Stats {
+        .memo_hits = hot::g_hook.memo_hits.get(),
+        .memo_misses = hot::g_hook.memo_misses.get(),
+        .skipped_stores = hot::g_hook.skipped_stores.get(),
+        .evicted_cameras = hot::g_hook.evicted_cameras.get(),
+    };
 }
 
 } /* namespace camera */
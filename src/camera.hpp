@@ -3,12 +3,75 @@
 
 #include "shared.hpp"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
+namespace config { struct Snapshot; }
+
 namespace camera {
 
 enum class Context { Hub, Room, Quest };
-void update(uintptr_t camera_address);
+constexpr auto context_count = size_t {3};
+
+enum class CameraID : uint32_t; // see camera_id.hpp
+
+// Fields of the game's camera object
+constexpr auto params_offset = uint32_t {0x5d0};
+constexpr auto camera_id_offset = uint32_t {0x13b8};
+
+// Camera fields covered by Params, relative to the camera object
+constexpr auto params_fields_begin = params_offset + 0x10;
+constexpr auto params_fields_end = params_offset + 0x24;
+
+// Offsets of shift, height, -distance and fov within the view params
+constexpr auto params_field_offsets = std::to_array<uint32_t>({0x10, 0x14, 0x18, 0x20});
+
+struct Params {
+    float fov      =  53.0f;
+    float distance = 380.0f;
+    float height   = 180.0f;
+    float shift    =   0.0f;
+
+    auto operator==(Params const&) const -> bool = default;
+
+    static auto from_context(Context context) -> Params;
+
+    // Packed SSE4.1 implementations, with one load and masked stores for the
+    // view param block
+    static auto from_memory(uintptr_t view_params) -> Params;
+    void to_memory(uintptr_t view_params) const;
+    auto adjust(Context context, CameraID camera_id, config::Snapshot const& snapshot) const -> Params;
+
+    // Scalar reference implementations, which the packed ones must match
+    static auto from_memory_scalar(uintptr_t view_params) -> Params;
+    void to_memory_scalar(uintptr_t view_params) const;
+    auto adjust_scalar(Context context, CameraID camera_id, config::Snapshot const& snapshot) const -> Params;
+};
+
+// The packed code loads and stores Params as one vector.
+static_assert(sizeof(Params) == 4 * sizeof(float) && offsetof(Params, shift) == 3 * sizeof(float));
+
+auto base_fov(Context context) -> float;
+auto proj_scale_from_fov(float fov) -> float;
+
+// Adjusts the camera's view params, returning false if they already held
+// the adjusted values and nothing had to be written.
+auto update(uintptr_t camera_address, config::Snapshot const& snapshot) -> bool;
+
+// Logs the frames that repeated the last logged adjustment, which are
+// otherwise only logged with the next change. Call once the hooks are gone
+// and the camera log is stopped.
+void flush_log();
+
+struct Stats {
+    uint64_t memo_hits = 0;
+    uint64_t memo_misses = 0;
+    uint64_t skipped_stores = 0;
+    uint64_t evicted_cameras = 0;
+};
+
+auto get_stats() -> Stats;
 
 } /* namespace camera */
 
@@ -0,0 +1,110 @@
+#ifndef MHWORLD_CUSTOM_FOV_CAMERA_ID_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_CAMERA_ID_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "shared.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace camera {
+
+enum class CameraID : uint32_t {
+    Normal              =   0,
+    Sprint              =   3,
+
+    Combat              =  83,
+
+    BaseHub             =  85,
+    BaseHubSprint       =  86,
+
+    LivingQuarters      = 118,
+    PrivateQuarters     = 119,
+    PrivateSuite        = 120,
+
+    SurveyorSet         = 147,
+
+    Seliana             = 252,
+    SelianaSprint       = 253,
+    SelianaHub          = 254,
+    SelianaHubSprint    = 255,
+    SelianaRoom         = 256,
+};
+
+// Covers all camera presets observed so far, IDs outside are left alone.
+constexpr auto camera_id_count = size_t {300};
+
+struct CameraInfo {
+    string_view name = {};
+    optional<Context> context = {}; // context entered when this preset is used
+    bool dont_touch = false;
+    bool room_shift = false;
+};
+
+namespace detail {
+
+struct CameraDefinition {
+    CameraID id;
+    CameraInfo info;
+};
+
+constexpr auto camera_definitions = std::to_array<CameraDefinition>({
+    {CameraID::Normal,           {.name = "Normal",           .context = Context::Quest}},
+    {CameraID::Sprint,           {.name = "Sprint",           .context = Context::Quest}},
+    {CameraID::Combat,           {.name = "Combat",           .context = Context::Quest}},
+    {CameraID::BaseHub,          {.name = "BaseHub",          .context = Context::Hub}},
+    {CameraID::BaseHubSprint,    {.name = "BaseHubSprint",    .context = Context::Hub}},
+    {CameraID::LivingQuarters,   {.name = "LivingQuarters",   .context = Context::Room, .room_shift = true}},
+    {CameraID::PrivateQuarters,  {.name = "PrivateQuarters",  .context = Context::Room, .room_shift = true}},
+    {CameraID::PrivateSuite,     {.name = "PrivateSuite",     .context = Context::Room, .room_shift = true}},
+    {CameraID::SurveyorSet,      {.name = "SurveyorSet",      .dont_touch = true}},
+    {CameraID::Seliana,          {.name = "Seliana",          .context = Context::Hub}},
+    {CameraID::SelianaSprint,    {.name = "SelianaSprint",    .context = Context::Hub}},
+    {CameraID::SelianaHub,       {.name = "SelianaHub",       .context = Context::Hub}},
+    {CameraID::SelianaHubSprint, {.name = "SelianaHubSprint", .context = Context::Hub}},
+    {CameraID::SelianaRoom,      {.name = "SelianaRoom",      .context = Context::Room, .room_shift = true}},
+});
+
+constexpr auto camera_infos = [] {
+    auto infos = std::array<CameraInfo, camera_id_count> {};
+    for (auto const& [id, info] : camera_definitions) infos[std::to_underlying(id)] = info;
+    return infos;
+}();
+
+constexpr auto unknown_camera_info = CameraInfo {};
+
+} /* namespace detail */
+
+constexpr
+auto find_camera_id(string_view name) -> optional<CameraID> {
+    for (auto const& [id, info] : detail::camera_definitions) {
+        if (info.name == name) return id;
+    }
+    return std::nullopt;
+}
+
+constexpr
+auto get_camera_info(CameraID id) -> CameraInfo const& {
+    auto const index = std::to_underlying(id);
+    if (index >= camera_id_count) return detail::unknown_camera_info;
+    return detail::camera_infos[index];
+}
+
+inline
+auto operator<<(LOG& log, CameraID camera_id) -> LOG& {
+    log << static_cast<int>(camera_id);
+    auto const name = get_camera_info(camera_id).name;
+    if (!name.empty()) log << " (" << name << ')';
+    return log;
+}
+
+static_assert(get_camera_info(CameraID::Combat).context == Context::Quest);
+static_assert(get_camera_info(CameraID::SurveyorSet).dont_touch);
+static_assert(get_camera_info(CameraID::SelianaRoom).room_shift);
+static_assert(find_camera_id("Sprint") == CameraID::Sprint);
+
+} /* namespace camera */
+
+#endif /* include guard */
@@ -0,0 +1,77 @@
+#include "camera_layout.hpp"
+
+#include "scanner.hpp"
+#include "shared.hpp"
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace camera_layout {
+
+namespace /* unnamed */ {
+
+constexpr auto function_body_size = size_t {0x1000};
+
+using Accesses = std::span<scanner::FieldAccess const>;
+
+auto covers(Accesses writes, uint32_t displacement) -> bool {
+    return std::ranges::any_of(writes, [&](scanner::FieldAccess const& write) {
+        return write.displacement <= displacement && displacement + 4 <= write.displacement + write.size;
+    });
+}
+
+// Several candidates are expected, since the functions touch other fields
+// too. Any that matches the known offset confirms it.
+auto choose(std::vector<uint32_t> const& candidates, uint32_t known_offset, string_view name) -> optional<uint32_t> {
+    if (candidates.empty()) {
+        LOGLINE(WARN) << "Could not find the " << name << " field.";
+        return std::nullopt;
+    }
+    if (std::ranges::contains(candidates, known_offset)) return known_offset;
+    return std::ranges::min(candidates);
+}
+
+auto find_params_offset(uintptr_t update_camera_addr) -> optional<uint32_t> {
+    auto writes = scanner::find_field_accesses(update_camera_addr, function_body_size);
+    std::erase_if(writes, [](scanner::FieldAccess const& access) { return !access.writes; });
+
+    auto candidates = std::vector<uint32_t> {};
+    for (auto const& write : writes) {
+        for (auto const field_offset : camera::params_field_offsets) {
+            if (write.displacement < field_offset) continue;
+            auto const params_offset = write.displacement - field_offset;
+            auto const covers_all = std::ranges::all_of(camera::params_field_offsets, [&](uint32_t offset) {
+                return covers(writes, params_offset + offset);
+            });
+            if (covers_all) candidates.push_back(params_offset);
+        }
+    }
+    return choose(candidates, known.params_offset, "view params");
+}
+
+// The init function stores its camera_id argument into the camera.
+auto find_camera_id_offset(uintptr_t init_camera_addr) -> optional<uint32_t> {
+    auto candidates = std::vector<uint32_t> {};
+    for (auto const& access : scanner::find_field_accesses(init_camera_addr, function_body_size)) {
+        if (access.size == 4 && access.stores_second_argument) candidates.push_back(access.displacement);
+    }
+    return choose(candidates, known.camera_id_offset, "camera ID");
+}
+
+} /* unnamed namespace */
+
+auto discover(uintptr_t init_camera_addr, uintptr_t update_camera_addr) -> optional<Layout> {
+    auto const params_offset = find_params_offset(update_camera_addr);
+    auto const camera_id_offset = find_camera_id_offset(init_camera_addr);
+    if (!params_offset || !camera_id_offset) return std::nullopt;
+    auto const layout = Layout {
+        .params_offset = *params_offset,
+        .camera_id_offset = *camera_id_offset,
+    };
+    LOGLINE(DEBUG) << "Found view params at 0x" << std::hex << layout.params_offset
+                   << " and camera ID at 0x" << layout.camera_id_offset << '.';
+    return layout;
+}
+
+} /* namespace camera_layout */
@@ -0,0 +1,31 @@
+#ifndef MHWORLD_CUSTOM_FOV_CAMERA_LAYOUT_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_CAMERA_LAYOUT_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "shared.hpp"
+
+#include <cstdint>
+
+namespace camera_layout {
+
+// Offsets of the camera object fields that camera::update accesses
+struct Layout {
+    uint32_t params_offset = camera::params_offset;
+    uint32_t camera_id_offset = camera::camera_id_offset;
+
+    auto operator==(Layout const&) const -> bool = default;
+};
+
+// The layout camera::update is compiled for
+constexpr auto known = Layout {};
+
+// Finds the fields from the displacements the located functions use on
+// their camera argument: the view params as a block whose fields the update
+// function writes, and the camera ID as the 32 bit field the init function
+// stores its camera_id argument in. Returns nothing if either isn't found,
+// and the caller has to reject any layout other than the known one.
+auto discover(uintptr_t init_camera_addr, uintptr_t update_camera_addr) -> optional<Layout>;
+
+} /* namespace camera_layout */
+
+#endif /* include guard */
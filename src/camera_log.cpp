@@ -0,0 +1,87 @@
+#include "camera_log.hpp"
+
+#include "camera_id.hpp"
+#include "shared.hpp"
+#include "spsc_ring.hpp"
+#include "worker.hpp"
+
+#include <iomanip>
+
+namespace camera_log {
+
+namespace /* unnamed */ {
+
+constexpr auto drain_interval_ms = DWORD {50};
+
+// Read by the camera hook for every record, and by the drain thread.
+struct alignas(cache_line_size) Shared {
+    std::atomic<bool> running = false;
+    Counter dropped = {};
+};
+
+auto g_thread = worker::Thread {};
+auto g_shared = Shared {};
+auto g_ring = SpscRing<Record, 256> {};
+auto g_start_time = int64_t {0};
+
+struct ParamChange {
+    string_view name;
+    float old_value;
+    float new_value;
+};
+
+auto operator<<(LOG& log, ParamChange const& change) -> LOG& {
+    log << change.name << ' ' << change.old_value;
+    if (change.old_value != change.new_value) log << " > " << change.new_value;
+    return log;
+}
+
+void format(Record const& record) {
+    if (record.repeated_frames > 0) LOGLINE(DEBUG) << "(repeated " << record.repeated_frames << " frames)";
+    auto const seconds = static_cast<double>(record.timestamp - g_start_time) / query_performance_frequency();
+    auto const& old_params = record.old_params;
+    auto const& new_params = record.new_params;
+    LOGLINE(DEBUG) << as_str(record.context) << ' ' << std::setw(3) << record.camera_id << ' '
+        << std::fixed << std::setprecision(0)
+        << ParamChange {"fov", old_params.fov, new_params.fov} << ", "
+        << ParamChange {"distance", old_params.distance, new_params.distance} << ", "
+        << ParamChange {"height", old_params.height, new_params.height} << ", "
+        << ParamChange {"shift", old_params.shift, new_params.shift}
+        << std::setprecision(3) << " @ " << seconds << 's';
+}
+
+auto g_reported_dropped = uint64_t {0};
+
+void drain() {
+    while (auto const record = g_ring.try_pop()) format(*record);
+    auto const dropped = g_shared.dropped.get();
+    if (dropped == g_reported_dropped) return;
+    LOGLINE(WARN) << "Dropped " << dropped - g_reported_dropped << " camera log records.";
+    g_reported_dropped = dropped;
+}
+
+void run(HANDLE stop_event) {
+    while (WaitForSingleObject(stop_event, drain_interval_ms) == WAIT_TIMEOUT) drain();
+    drain();
+}
+
+} /* unnamed namespace */
+
+auto start() -> bool {
+    g_start_time = query_performance_counter();
+    if (!g_thread.start("camera log", run)) return false;
+    g_shared.running.store(true, std::memory_order_release);
+    return true;
+}
+
+void stop() {
+    g_shared.running.store(false, std::memory_order_release);
+    g_thread.stop();
+}
+
+void write(Record const& record) {
+    if (!g_shared.running.load(std::memory_order_acquire)) return format(record);
+    if (!g_ring.try_push(record)) g_shared.dropped.add();
+}
+
+} /* namespace camera_log */
@@ -0,0 +1,31 @@
+#ifndef MHWORLD_CUSTOM_FOV_CAMERA_LOG_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_CAMERA_LOG_HPP_INCLUDED
+
+#include "camera.hpp"
+
+#include <cstdint>
+
+namespace camera_log {
+
+struct Record {
+    int64_t timestamp = 0;         // performance counter
+    uint64_t repeated_frames = 0;  // frames that repeated the previous record
+    camera::Context context = {};
+    camera::CameraID camera_id = {};
+    camera::Params old_params = {};
+    camera::Params new_params = {};
+};
+
+// Format camera log records on a background thread, so the camera hooks
+// never do string formatting or file I/O. Records are written directly if
+// the thread is not running.
+auto start() -> bool;
+void stop();
+
+// Only call from the camera hook thread. Never blocks, records are dropped
+// and counted if the background thread falls behind.
+void write(Record const& record);
+
+} /* namespace camera_log */
+
+#endif /* include guard */
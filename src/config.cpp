@@ -1,21 +1,46 @@
 #include "config.hpp"
 
+#include "alloc_guard.hpp"
+#include "config_cache.hpp"
+#include "hot_state.hpp"
+#include "key_set.hpp"
+#include "profiler.hpp"
 #include "shared.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
+#include "watchdog.hpp"
+#include "zones.hpp"
 
 #define TOML_EXCEPTIONS 0
 #include "toml.hpp"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-using camera::Context;
+using camera::CameraID, camera::Context;
 
 namespace config {
 
 namespace /* unnamed */ {
 
+// Problems logged while reading the current file. A config with any is not
+// cached, so they are logged again on every launch until they are fixed.
+thread_local auto t_problems = uint32_t {0};
+
 struct Trace {
     Trace const* parent;
     string_view key;
@@ -31,6 +56,7 @@ auto operator<<(LOG& log, Trace const& trace) -> LOG&
 template <typename T> constexpr auto type_name() -> string_view = delete;
 template <> constexpr auto type_name<bool>() -> string_view { return "boolean"; }
 template <> constexpr auto type_name<float>() -> string_view { return "floating-point"; }
+template <> constexpr auto type_name<int64_t>() -> string_view { return "integer"; }
 
 template <typename T>
 auto read_value(toml::table const& table, string_view key, Trace const* trace)
@@ -44,6 +70,7 @@ auto read_value(toml::table const& table, string_view key, Trace const* trace)
         auto const expected_type = type_name<T>();
         LOGLINE(ERR) << "Expected " << node_trace << " to be a " << expected_type
             << ", but got a " << node_view.type() << '!';
+        ++t_problems;
         return std::nullopt;
     }
     return *value;
@@ -63,40 +90,348 @@ auto from_table_at_key(toml::table const& table, string_view key, Trace const* t
         auto const expected_type = "table"sv;
         LOGLINE(ERR) << "Expected " << node_trace << " to be a " << expected_type
             << ", but got a " << node_view.type() << '!';
+        ++t_problems;
         return defaults;
     }
     return from_table<T>(*node_view.as_table(), &node_trace, defaults);
 }
 
-void warn_unknown_keys(toml::table const& table, std::span<string_view const> expected_keys, Trace const* trace) {
+// Every config key is described once below. Defaults are the member
+// initializers in config.hpp.
+
+struct SettingsField {
+    string_view key;
+    optional<float> SettingsOverride::* member;
+    optional<Interval> range = {}; // values outside are clamped
+};
+
+template <typename T>
+struct Option {
+    string_view key;
+    T UserConfig::* member;
+};
+
+// Context tables inherit the top level settings.
+struct ContextSection {
+    string_view key;
+    Settings UserConfig::* member;
+};
+
+constexpr auto camera_key = "camera"sv;
+
+constexpr auto settings_fields = std::to_array<SettingsField>({
+    { .key = "fov", .member = &SettingsOverride::fov, .range = fov_range },
+    { .key = "distance", .member = &SettingsOverride::distance },
+    { .key = "height", .member = &SettingsOverride::height },
+});
+
+// Removed options, still accepted in settings tables of old config files
+constexpr auto retired_settings_keys = std::to_array<string_view>({"shift"});
+
+constexpr auto context_sections = std::to_array<ContextSection>({
+    { .key = "hub", .member = &UserConfig::hub_cam },
+    { .key = "room", .member = &UserConfig::room_cam },
+    { .key = "quest", .member = &UserConfig::quest_cam },
+});
+
+constexpr auto bool_options = std::to_array<Option<bool>>({
+    { .key = "disable_room_shift", .member = &UserConfig::disable_room_shift },
+    { .key = "profile_hooks", .member = &UserConfig::profile_hooks },
+    { .key = "check_allocations", .member = &UserConfig::check_allocations },
+    { .key = "publish_telemetry", .member = &UserConfig::publish_telemetry },
+    { .key = "capture_trace", .member = &UserConfig::capture_trace },
+    { .key = "trace_circular", .member = &UserConfig::trace_circular },
+});
+
+constexpr auto integer_options = std::to_array<Option<int64_t>>({
+    { .key = "profile_interval", .member = &UserConfig::profile_interval },
+    { .key = "trace_frames", .member = &UserConfig::trace_frames },
+    { .key = "hook_budget_us", .member = &UserConfig::hook_budget_us },
+});
+
+constexpr auto key_of(string_view key) -> string_view { return key; }
+constexpr auto key_of(auto const& field) -> string_view { return field.key; }
+
+template <typename... Tables>
+consteval auto collect_keys(Tables const&... tables) {
+    auto keys = std::array<string_view, (std::tuple_size_v<Tables> + ...)> {};
+    auto out = keys.begin();
+    ([&] { for (auto const& field : tables) *out++ = key_of(field); }(), ...);
+    return keys;
+}
+
+constexpr auto settings_keys = KeySet {collect_keys(settings_fields, retired_settings_keys)};
+constexpr auto top_level_keys = KeySet {collect_keys(
+    settings_fields, context_sections, std::array {camera_key}, bool_options, integer_options
+)};
+
+static_assert(settings_keys.is_perfect() && top_level_keys.is_perfect(), "config keys must be unique");
+
+template <size_t Count>
+void warn_unknown_keys(toml::table const& table, KeySet<Count> const& expected_keys, Trace const* trace) {
     for (auto&& [key, value] : table) {
-        if (!std::ranges::contains(expected_keys, key)) {
+        if (!expected_keys.contains(key)) {
             auto key_trace = Trace {trace, key};
             LOGLINE(WARN) << "Unknown key " << key_trace << " will be ignored.";
+            ++t_problems;
         }
     }
 }
 
-auto clamp_fov(float value) -> float {
-    constexpr auto fov_range = Interval { .lower = 30.0f, .upper = 120.0f };
-    auto const clamped = std::clamp(value, fov_range.lower, fov_range.upper);
-    if (clamped != value) LOGLINE(WARN) << "FOV clamped to range [" << fov_range.lower << ", " << fov_range.upper << "].";
+auto read_field(toml::table const& table, SettingsField const& field, Trace const* trace) -> optional<float> {
+    auto const value = read_value<float>(table, field.key, trace);
+    if (!value.has_value() || !field.range.has_value()) return value;
+    auto const [lower, upper] = *field.range;
+    auto const clamped = std::clamp(*value, lower, upper);
+    if (clamped != *value) {
+        auto const field_trace = Trace {trace, field.key};
+        LOGLINE(WARN) << "Clamped " << field_trace << " to range [" << lower << ", " << upper << "].";
+        ++t_problems;
+    }
     return clamped;
 }
 
+template <>
+auto from_table<SettingsOverride>(toml::table const& table, Trace const *trace, SettingsOverride const&)
+  -> SettingsOverride
+{
+    if (trace != nullptr) warn_unknown_keys(table, settings_keys, trace);
+    auto settings = SettingsOverride {};
+    for (auto const& field : settings_fields) settings.*field.member = read_field(table, field, trace);
+    return settings;
+}
+
 template <>
 auto from_table<Settings>(toml::table const& table, Trace const *trace, Settings const& defaults) -> Settings {
-    constexpr auto expected_keys = std::to_array<string_view>({"fov", "distance", "height", "shift"});
-    if (trace != nullptr) warn_unknown_keys(table, expected_keys, trace);
-    return Settings {
-        .fov      = read_value<float>(table, "fov", trace).transform(clamp_fov).value_or(defaults.fov),
-        .distance = read_value<float>(table, "distance", trace).value_or(defaults.distance),
-        .height   = read_value<float>(table, "height", trace).value_or(defaults.height),
+    return from_table<SettingsOverride>(table, trace, {}).apply(defaults);
+}
+
+auto parse_camera_id(string_view key) -> optional<CameraID> {
+    auto value = uint32_t {};
+    auto const [end, error] = std::from_chars(key.data(), key.data() + key.size(), value);
+    if (error == std::errc {} && end == key.data() + key.size()) {
+        if (value >= camera::camera_id_count) return std::nullopt;
+        return static_cast<CameraID>(value);
+    }
+    return camera::find_camera_id(key);
+}
+
+auto read_camera_overrides(toml::table const& table) -> std::vector<CameraOverride> {
+    auto const camera_trace = Trace {nullptr, camera_key};
+    auto const node_view = table[camera_key];
+    if (!node_view) return {};
+    if (!node_view.is_table()) {
+        LOGLINE(ERR) << "Expected " << camera_trace << " to be a table, but got a " << node_view.type() << '!';
+        ++t_problems;
+        return {};
+    }
+    auto overrides = std::vector<CameraOverride> {};
+    for (auto&& [camera_key, value] : *node_view.as_table()) {
+        auto const camera_id = parse_camera_id(camera_key.str());
+        auto const node_trace = Trace {&camera_trace, camera_key.str()};
+        if (!camera_id.has_value()) {
+            LOGLINE(WARN) << "Unknown camera " << node_trace << " will be ignored.";
+            ++t_problems;
+            continue;
+        }
+        auto const settings = from_table_at_key<SettingsOverride>(*node_view.as_table(), camera_key.str(), &camera_trace, {});
+        overrides.push_back(CameraOverride { .camera_id = *camera_id, .settings = settings });
+    }
+    return overrides;
+}
+
+auto make_adjustment(Settings const& settings, float base_proj) -> Adjustment {
+    return Adjustment {
+        .proj_scale = camera::proj_scale_from_fov(settings.fov) / base_proj,
+        .distance = settings.distance,
+        .height = settings.height,
     };
 }
 
-auto g_config = UserConfig {};
-auto g_config_last_write_time = std::optional<std::filesystem::file_time_type> {};
+auto read_user_config(toml::table const& table) -> UserConfig {
+    warn_unknown_keys(table, top_level_keys, nullptr);
+
+    auto config = UserConfig {};
+    auto const global_cam = from_table<Settings>(table, nullptr, Settings {});
+    for (auto const& section : context_sections) {
+        config.*section.member = from_table_at_key<Settings>(table, section.key, nullptr, global_cam);
+    }
+    config.camera_overrides = read_camera_overrides(table);
+    for (auto const& option : bool_options) {
+        config.*option.member = read_value<bool>(table, option.key, nullptr).value_or(config.*option.member);
+    }
+    for (auto const& option : integer_options) {
+        config.*option.member = read_value<int64_t>(table, option.key, nullptr).value_or(config.*option.member);
+    }
+    return config;
+}
+
+auto from_parse_result(toml::parse_result const& parse_result) -> optional<UserConfig> {
+    if (parse_result.failed()) {
+        auto const& error = parse_result.error();
+        LOGLINE(ERR) << error.description();
+        LOGLINE(ERR) << "^ occured on " << error.source();
+        return std::nullopt;
+    }
+    return read_user_config(parse_result.table());
+}
+
+template <typename T>
+constexpr auto hash_value(T const& value, uint64_t hash) -> uint64_t {
+    auto const bytes = std::bit_cast<std::array<char, sizeof(T)>>(value);
+    return config_cache::hash_bytes(string_view {bytes.data(), bytes.size()}, hash);
+}
+
+// Binary form of a UserConfig for the config cache, in schema order. Cached
+// configs have the defaults and clamping of the build that wrote them
+// applied, so schema_hash covers those and the encoded layouts as well as
+// the keys. Any change to them invalidates old caches.
+constexpr auto schema_hash = [] {
+    auto hash = config_cache::hash_bytes("CustomFOV config");
+    auto const keys = collect_keys(context_sections, settings_fields, bool_options, integer_options);
+    for (auto const key : keys) hash = config_cache::hash_bytes(key, config_cache::hash_bytes("\n", hash));
+
+    hash = hash_value(sizeof(Settings), hash);
+    hash = hash_value(offsetof(Settings, fov), hash);
+    hash = hash_value(offsetof(Settings, distance), hash);
+    hash = hash_value(offsetof(Settings, height), hash);
+    hash = hash_value(sizeof(CameraID), hash);
+    hash = hash_value(camera::camera_id_count, hash);
+    for (auto const& field : settings_fields) {
+        hash = hash_value(field.range.has_value(), hash);
+        if (field.range.has_value()) hash = hash_value(*field.range, hash);
+    }
+
+    auto const defaults = UserConfig {};
+    hash = hash_value(Settings {}, hash);
+    for (auto const& section : context_sections) hash = hash_value(defaults.*section.member, hash);
+    for (auto const& option : bool_options) hash = hash_value(defaults.*option.member, hash);
+    for (auto const& option : integer_options) hash = hash_value(defaults.*option.member, hash);
+    return hash;
+}();
+
+class Encoder {
+public:
+    template <typename T>
+    void put(T const& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto const bytes = reinterpret_cast<uint8_t const*>(&value);
+        this->bytes.insert(this->bytes.end(), bytes, bytes + sizeof(T));
+    }
+
+    auto take() -> std::vector<uint8_t> { return std::move(this->bytes); }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+// Fails once a read runs past the end.
+class Decoder {
+public:
+    explicit Decoder(std::span<uint8_t const> bytes) : rest(bytes) {}
+
+    template <typename T>
+    auto get() -> optional<T> {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (this->rest.size() < sizeof(T)) return std::nullopt;
+        auto value = T {};
+        std::memcpy(&value, this->rest.data(), sizeof(T));
+        this->rest = this->rest.subspan(sizeof(T));
+        return value;
+    }
+
+    auto get_bool() -> optional<bool> {
+        auto const value = this->get<uint8_t>();
+        if (!value.has_value() || *value > 1) return std::nullopt;
+        return *value != 0;
+    }
+
+    auto at_end() const -> bool { return this->rest.empty(); }
+
+private:
+    std::span<uint8_t const> rest;
+};
+
+auto encode(UserConfig const& config) -> std::vector<uint8_t> {
+    auto encoder = Encoder {};
+    for (auto const& section : context_sections) encoder.put(config.*section.member);
+    encoder.put(static_cast<uint32_t>(config.camera_overrides.size()));
+    for (auto const& [camera_id, settings] : config.camera_overrides) {
+        encoder.put(camera_id);
+        for (auto const& field : settings_fields) {
+            auto const& value = settings.*field.member;
+            encoder.put(static_cast<uint8_t>(value.has_value()));
+            encoder.put(value.value_or(0.0f));
+        }
+    }
+    for (auto const& option : bool_options) encoder.put(static_cast<uint8_t>(config.*option.member));
+    for (auto const& option : integer_options) encoder.put(config.*option.member);
+    return encoder.take();
+}
+
+auto decode(std::span<uint8_t const> bytes) -> optional<UserConfig> {
+    auto decoder = Decoder {bytes};
+    auto config = UserConfig {};
+    for (auto const& section : context_sections) {
+        auto const settings = decoder.get<Settings>();
+        if (!settings.has_value()) return std::nullopt;
+        config.*section.member = *settings;
+    }
+    auto const override_count = decoder.get<uint32_t>();
+    if (!override_count.has_value() || *override_count > camera::camera_id_count) return std::nullopt;
+    for (auto i = uint32_t {0}; i < *override_count; ++i) {
+        auto const camera_id = decoder.get<CameraID>();
+        if (!camera_id.has_value() || std::to_underlying(*camera_id) >= camera::camera_id_count) return std::nullopt;
+        auto settings = SettingsOverride {};
+        for (auto const& field : settings_fields) {
+            auto const has_value = decoder.get_bool();
+            auto const value = decoder.get<float>();
+            if (!has_value.has_value() || !value.has_value()) return std::nullopt;
+            if (*has_value) settings.*field.member = *value;
+        }
+        config.camera_overrides.push_back(CameraOverride { .camera_id = *camera_id, .settings = settings });
+    }
+    for (auto const& option : bool_options) {
+        auto const value = decoder.get_bool();
+        if (!value.has_value()) return std::nullopt;
+        config.*option.member = *value;
+    }
+    for (auto const& option : integer_options) {
+        auto const value = decoder.get<int64_t>();
+        if (!value.has_value()) return std::nullopt;
+        config.*option.member = *value;
+    }
+    if (!decoder.at_end()) return std::nullopt;
+    return config;
+}
+
+// Snapshots are only ever published from one thread at a time: either the
+// watcher thread, or the camera hook when polling, or the standby poller
+// while the watchdog keeps the hook from polling. Readers on other threads
+// share the line with the hook, so it holds nothing else.
+struct alignas(cache_line_size) Published {
+    std::atomic<Snapshot const*> snapshot;
+    std::atomic<uint32_t> readers = 0;
+};
+
+auto const g_default_snapshot = Snapshot::from_config(UserConfig {}, 0);
+auto g_published = Published { .snapshot = &g_default_snapshot };
+auto g_retired = std::vector<std::unique_ptr<Snapshot const>> {};
+auto g_version = uint32_t {0};
+
+// Held while loading, since polling moves between the hook and the standby
+// poller. The hook never waits for it.
+auto g_load_mutex = std::mutex {};
+
+// The polled config file, only used under g_load_mutex. It is kept out of
+// hot::g_hook on purpose: each poll costs a file system call, which dwarfs
+// any cache miss on these, and the path owns heap memory.
+struct PolledFile {
+    std::filesystem::path path = {}; // converted once, on the first poll
+    optional<std::filesystem::file_time_type> last_write_time = {};
+};
+
+auto g_polled_file = PolledFile {};
 
 auto get_config_path(string_view version) -> std::optional<string_view> {
     if (version.starts_with("314")) return "ICE/ntPC/plugins/CustomFOV.toml"sv;
@@ -104,71 +439,159 @@ auto get_config_path(string_view version) -> std::optional<string_view> {
     return std::nullopt;
 }
 
+auto read_config_if_changed() -> optional<UserConfig> {
+    auto const path = get_config_path(GameVersion);
+    if (!path.has_value()) return std::nullopt;
+
+    auto& polled = g_polled_file;
+    if (polled.path.empty()) polled.path = *path;
+    auto error_code = std::error_code {};
+    auto const last_write_time = std::filesystem::last_write_time(polled.path, error_code);
+    if (error_code) return std::nullopt; // check again next time
+
+    if (polled.last_write_time.has_value() && last_write_time <= *polled.last_write_time) return std::nullopt;
+    polled.last_write_time = last_write_time;
+
+    auto config_result = UserConfig::load(*path);
+    if (!config_result.has_value()) LOGLINE(WARN) << "Keeping existing settings.";
+    return config_result;
+}
+
+void publish(UserConfig const& config) {
+    auto next = std::make_unique<Snapshot const>(Snapshot::from_config(config, ++g_version));
+    auto const previous = g_published.snapshot.exchange(next.release());
+    if (previous != &g_default_snapshot) g_retired.emplace_back(previous);
+    profiler::configure(config.profile_hooks, config.profile_interval);
+    alloc_guard::configure(config.check_allocations);
+    telemetry::configure(config.publish_telemetry);
+    trace::configure(trace::Settings {
+        .enabled = config.capture_trace,
+        .records = static_cast<uint64_t>(std::max<int64_t>(config.trace_frames, 0)),
+        .circular = config.trace_circular,
+    });
+    watchdog::configure(config.hook_budget_us);
+    // Readers of a retired snapshot entered their read section before it was
+    // swapped out. Once no reader is left, none of them can still be in use.
+    if (g_published.readers.load() == 0) g_retired.clear();
+}
+
+void load_config_locked() {
+    auto const config_result = read_config_if_changed();
+    if (config_result.has_value()) publish(*config_result);
+}
+
 } /* unnamed namespace */
 
 auto is_supported_version() -> bool {
     return get_config_path(GameVersion).has_value();
 }
 
+auto get_config_path() -> optional<string_view> {
+    return get_config_path(GameVersion);
+}
+
 auto UserConfig::from_file(string_view path) -> optional<UserConfig> {
+    ZONE("UserConfig::from_file");
     LOGLINE(DEBUG) << "Parsing config file '" << path << "'...";
-    auto const parse_result = toml::parse_file(path);
-    if (parse_result.failed()) {
-        auto const& error = parse_result.error();
-        LOGLINE(ERR) << error.description();
-        LOGLINE(ERR) << "^ occured on " << error.source();
+    return from_parse_result(toml::parse_file(path));
+}
+
+auto UserConfig::load(string_view path) -> optional<UserConfig> {
+    ZONE("UserConfig::load");
+    auto const file_path = std::filesystem::path {path};
+    auto error_code = std::error_code {};
+    auto const write_time = std::filesystem::last_write_time(file_path, error_code);
+    auto const size = error_code ? 0 : std::filesystem::file_size(file_path, error_code);
+    auto stream = std::ifstream {file_path, std::ios::binary};
+    auto text = std::string(size, '\0');
+    if (error_code || !stream.read(text.data(), static_cast<std::streamsize>(text.size()))) {
+        LOGLINE(ERR) << "Failed to read config file '" << path << "'!";
         return std::nullopt;
     }
-    auto const& table = parse_result.table();
-    constexpr auto expected_keys = std::to_array<string_view>({
-        "fov", "distance", "height", "hub", "room", "quest", "disable_room_shift"
-    });
-    warn_unknown_keys(table, expected_keys, nullptr);
-
-    auto const global_cam = from_table<Settings>(table, nullptr, Settings {});
-    auto resolve_settings = [&](Context context) {
-        return from_table_at_key<Settings>(table, as_str(context), nullptr, global_cam);
+    auto const source = config_cache::Source {
+        .size = text.size(),
+        .write_time = write_time.time_since_epoch().count(),
+        .content_hash = config_cache::hash_bytes(text),
     };
+    auto const payload = config_cache::load(file_path, source, schema_hash);
+    if (payload.has_value()) {
+        auto config = decode(*payload);
+        if (config.has_value()) {
+            LOGLINE(DEBUG) << "Using cached config for '" << path << "'.";
+            return config;
+        }
+    }
 
-    return UserConfig {
-        .hub_cam = resolve_settings(Context::Hub),
-        .room_cam = resolve_settings(Context::Room),
-        .quest_cam = resolve_settings(Context::Quest),
-        .disable_room_shift = read_value<bool>(table, "disable_room_shift", nullptr)
-            .value_or(false),
-    };
+    LOGLINE(DEBUG) << "Parsing config file '" << path << "'...";
+    t_problems = 0;
+    auto config = from_parse_result(toml::parse(text, path));
+    if (config.has_value() && t_problems == 0) config_cache::store(file_path, source, schema_hash, encode(*config));
+    return config;
 }
 
 auto UserConfig::get_settings(Context context) const -> Settings const& {
     switch (context) {
-        case Context::Hub:   return g_config.hub_cam;
-        case Context::Room:  return g_config.room_cam;
-        case Context::Quest: return g_config.quest_cam;
+        case Context::Hub:   return this->hub_cam;
+        case Context::Room:  return this->room_cam;
+        case Context::Quest: return this->quest_cam;
+    }
+    return this->hub_cam;
+}
+
+auto SettingsOverride::apply(Settings const& base) const -> Settings {
+    return Settings {
+        .fov      = this->fov.value_or(base.fov),
+        .distance = this->distance.value_or(base.distance),
+        .height   = this->height.value_or(base.height),
+    };
+}
+
+auto Snapshot::from_config(UserConfig const& config, uint32_t version) -> Snapshot {
+    auto snapshot = Snapshot { .version = version, .config = config };
+    for (auto const context : {Context::Hub, Context::Room, Context::Quest}) {
+        auto const& settings = config.get_settings(context);
+        auto const base_proj = camera::proj_scale_from_fov(camera::base_fov(context));
+        auto& adjustments = snapshot.adjustments[std::to_underlying(context)];
+        adjustments.fill(make_adjustment(settings, base_proj));
+        for (auto const& [camera_id, camera_settings] : config.camera_overrides) {
+            adjustments[std::to_underlying(camera_id)] = make_adjustment(camera_settings.apply(settings), base_proj);
+        }
+        if (!config.disable_room_shift) continue;
+        for (auto id = uint32_t {0}; id < camera::camera_id_count; ++id) {
+            if (camera::get_camera_info(CameraID {id}).room_shift) adjustments[id].shift = 0.0f;
+        }
     }
-    return g_config.hub_cam;
+    return snapshot;
 }
 
-auto get_config() -> UserConfig const& {
-    return g_config;
+auto Snapshot::get_adjustment(Context context, CameraID camera_id) const -> Adjustment const& {
+    auto const index = std::min<size_t>(std::to_underlying(camera_id), camera::camera_id_count);
+    return this->adjustments[std::to_underlying(context)][index];
 }
 
-void reload_config() {
-    auto const path = get_config_path(GameVersion);
-    if (!path.has_value()) return;
+ReadSection::ReadSection() {
+    g_published.readers.fetch_add(1);
+    this->current = g_published.snapshot.load();
+}
 
-    auto error_code = std::error_code {};
-    auto const last_write_time = std::filesystem::last_write_time(*path, error_code);
-    if (error_code) return; // check again next time
+ReadSection::~ReadSection() {
+    g_published.readers.fetch_sub(1, std::memory_order_release);
+}
+
+void enable_background_reload() {
+    hot::g_hook.background_reload = true;
+}
 
-    if (g_config_last_write_time.has_value() && last_write_time <= *g_config_last_write_time) return;
+void load_config() {
+    auto const lock = std::scoped_lock {g_load_mutex};
+    load_config_locked();
+}
 
-    auto const config_result = UserConfig::from_file(*path);
-    if (config_result.has_value()) {
-        g_config = *config_result;
-    } else {
-        LOGLINE(WARN) << "Keeping existing settings.";
-    }
-    g_config_last_write_time = last_write_time;
+void reload_config() {
+    ZONE("config::reload_config");
+    if (hot::g_hook.background_reload) return;
+    auto const lock = std::unique_lock {g_load_mutex, std::try_to_lock};
+    if (lock.owns_lock()) load_config_locked();
 }
 
 } /* namespace config */
@@ -2,10 +2,16 @@
 #define MHWORLD_CUSTOM_FOV_CONFIG_HPP_INCLUDED
 
 #include "camera.hpp"
+#include "camera_id.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
 
 namespace config {
 
 constexpr float default_fov = 53.0f;
+constexpr auto fov_range = Interval { .lower = 30.0f, .upper = 120.0f };
 
 struct Settings {
     float fov = default_fov;
@@ -13,21 +19,97 @@ struct Settings {
     float height = 1.0f;
 };
 
+struct SettingsOverride {
+    optional<float> fov = {};
+    optional<float> distance = {};
+    optional<float> height = {};
+
+    auto apply(Settings const& base) const -> Settings;
+};
+
+struct CameraOverride {
+    camera::CameraID camera_id;
+    SettingsOverride settings;
+};
+
 struct UserConfig {
     Settings hub_cam = {};
     Settings room_cam = {};
     Settings quest_cam = {};
+    std::vector<CameraOverride> camera_overrides = {};
 
     bool disable_room_shift = false;
 
+    bool profile_hooks = false;
+    int64_t profile_interval = 60;
+    bool check_allocations = false;
+    bool publish_telemetry = false;
+    bool capture_trace = false;
+    int64_t trace_frames = 262144;
+    bool trace_circular = true;
+    int64_t hook_budget_us = 2000;
+
     static
     auto from_file(string_view path) -> optional<UserConfig>;
+    // Like from_file, but reuses the config cache next to the file while
+    // its contents are unchanged.
+    static
+    auto load(string_view path) -> optional<UserConfig>;
     auto get_settings(camera::Context context) const -> Settings const&;
 };
 
+// Derived from the settings of a context once per config load, so the camera
+// hooks only need to apply them.
+struct Adjustment {
+    float proj_scale = 1.0f; // relative to the vanilla projection scale
+    float distance = 1.0f;
+    float height = 1.0f;
+    float shift = 1.0f; // 0 if the room shift is disabled for the camera
+};
+
+// Published config, immutable once visible to the camera hooks. Camera
+// overrides are resolved for every context, since presets without a context
+// of their own keep the previous one. The last entry of each row is used for
+// camera IDs outside the known range.
+struct Snapshot {
+    using Adjustments = std::array<Adjustment, camera::camera_id_count + 1>;
+
+    uint32_t version = 0;
+    UserConfig config = {};
+    std::array<Adjustments, camera::context_count> adjustments = {};
+
+    static
+    auto from_config(UserConfig const& config, uint32_t version) -> Snapshot;
+    auto get_adjustment(camera::Context context, camera::CameraID camera_id) const -> Adjustment const&;
+};
+
+// Keeps the current snapshot alive until the end of the scope. Must not be
+// held while calling reload_config().
+class ReadSection {
+public:
+    ReadSection();
+    ~ReadSection();
+    ReadSection(ReadSection const&) = delete;
+    auto operator=(ReadSection const&) -> ReadSection& = delete;
+
+    auto snapshot() const -> Snapshot const& { return *this->current; }
+
+private:
+    Snapshot const* current;
+};
+
 auto is_supported_version() -> bool;
+auto get_config_path() -> optional<string_view>;
+
+// Hand reloading over to a background thread which calls load_config() when
+// the file changes. Must be called before the camera hooks are installed.
+void enable_background_reload();
+void load_config();
+
+// Called from the camera hooks. Polls the file unless background reloading
+// is enabled, in which case new snapshots are published by the watcher, or by
+// the standby poller while the watchdog keeps the hooks from polling.
 void reload_config();
-auto get_config() -> UserConfig const&;
 
 } /* namespace config */
 
@@ -0,0 +1,71 @@
+#include "config_cache.hpp"
+
+#include "shared.hpp"
+
+#include <fstream>
+
+namespace config_cache {
+
+namespace /* unnamed */ {
+
+constexpr auto file_magic = uint32_t {0x43434643}; // "CFCC"
+constexpr auto file_format = uint32_t {1};
+constexpr auto max_payload_size = uint32_t {1} << 20;
+
+struct Header {
+    uint32_t magic = file_magic;
+    uint32_t format = file_format;
+    uint64_t schema_hash = 0;
+    Source source = {};
+    uint32_t payload_size = 0;
+    uint32_t reserved = 0;
+    uint64_t payload_hash = 0;
+};
+
+auto get_cache_path(std::filesystem::path const& config_path) -> std::filesystem::path {
+    return std::filesystem::path {config_path}.replace_extension(".config.cache");
+}
+
+auto hash_payload(std::span<uint8_t const> payload) -> uint64_t {
+    return hash_bytes(string_view {reinterpret_cast<char const*>(payload.data()), payload.size()});
+}
+
+} /* unnamed namespace */
+
+auto load(std::filesystem::path const& config_path, Source const& source, uint64_t schema_hash)
+    -> optional<std::vector<uint8_t>>
+{
+    auto stream = std::ifstream {get_cache_path(config_path), std::ios::binary};
+    auto header = Header {};
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) return std::nullopt;
+    if (header.magic != file_magic || header.format != file_format) return std::nullopt;
+    if (header.schema_hash != schema_hash || header.source != source) return std::nullopt;
+    if (header.payload_size > max_payload_size) return std::nullopt;
+
+    auto payload = std::vector<uint8_t>(header.payload_size);
+    if (!stream.read(reinterpret_cast<char*>(payload.data()), payload.size())) return std::nullopt;
+    if (hash_payload(payload) != header.payload_hash) {
+        LOGLINE(DEBUG) << "Config cache is corrupted.";
+        return std::nullopt;
+    }
+    return payload;
+}
+
+void store(std::filesystem::path const& config_path, Source const& source, uint64_t schema_hash,
+           std::span<uint8_t const> payload)
+{
+    if (payload.size() > max_payload_size) return;
+    auto const path = get_cache_path(config_path);
+    auto const header = Header {
+        .schema_hash = schema_hash,
+        .source = source,
+        .payload_size = static_cast<uint32_t>(payload.size()),
+        .payload_hash = hash_payload(payload),
+    };
+    auto stream = std::ofstream {path, std::ios::binary | std::ios::trunc};
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<char const*>(payload.data()), payload.size());
+    if (!stream) LOGLINE(WARN) << "Failed to write config cache '" << path.string() << "'.";
+}
+
+} /* namespace config_cache */
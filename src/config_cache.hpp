@@ -0,0 +1,39 @@
+#ifndef MHWORLD_CUSTOM_FOV_CONFIG_CACHE_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_CONFIG_CACHE_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Binary copy of the parsed config next to the TOML file, so an unchanged
+// file is not parsed again on the next launch.
+namespace config_cache {
+
+// The config file an entry was written for
+struct Source {
+    uint64_t size = 0;
+    int64_t write_time = 0;
+    uint64_t content_hash = 0;
+
+    auto operator==(Source const&) const -> bool = default;
+};
+
+// FNV-1a, chained through hash
+constexpr auto hash_bytes(string_view bytes, uint64_t hash = 14695981039346656037ull) -> uint64_t {
+    for (auto const c : bytes) hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    return hash;
+}
+
+// Returns the stored payload if it was written for the same source, by the
+// same config schema.
+auto load(std::filesystem::path const& config_path, Source const& source, uint64_t schema_hash)
+    -> optional<std::vector<uint8_t>>;
+void store(std::filesystem::path const& config_path, Source const& source, uint64_t schema_hash,
+           std::span<uint8_t const> payload);
+
+} /* namespace config_cache */
+
+#endif /* include guard */
@@ -1,6 +1,21 @@
+#include "address_cache.hpp"
+#include "alloc_guard.hpp"
+#include "api.hpp"
 #include "camera.hpp"
+#include "camera_layout.hpp"
+#include "camera_log.hpp"
 #include "config.hpp"
+#include "hook_set.hpp"
+#include "hot_state.hpp"
+#include "profiler.hpp"
+#include "scanner.hpp"
 #include "shared.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
+#include "watchdog.hpp"
+#include "watcher.hpp"
+#include "worker.hpp"
+#include "zones.hpp"
 
 #include "safetyhook.hpp"
 
@@ -8,23 +23,214 @@
 #include <windows.h>
 
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <span>
 
 namespace /* unnamed */ {
 
 auto g_init_camera_hook = SafetyHookInline {};
 auto g_update_camera_hook = SafetyHookInline {};
+auto g_update_params_hook = SafetyHookMid {};
+auto g_hooks = hooks::HookSet {safetyhook::Allocator::create()};
+
+// While the game leaves the view params alone, the per-frame update hook
+// has nothing to do and is disabled. A preset change, a config change or a
+// periodic probe enables it again. A probe that finds the params overwritten
+// doubles the number of stable frames needed before the next flip.
+constexpr auto dormant_after_frames = uint32_t {300};
+constexpr auto dormant_max_backoff = uint32_t {16};
+constexpr auto dormant_probe_ms = 1000.0;
+constexpr auto dormancy_poll_ms = DWORD {100};
+
+auto set_update_hook_enabled(bool enabled) -> bool {
+    if (g_update_params_hook) {
+        return (enabled ? g_update_params_hook.enable() : g_update_params_hook.disable()).has_value();
+    }
+    return (enabled ? g_update_camera_hook.enable() : g_update_camera_hook.disable()).has_value();
+}
+
+// The dormancy thread takes the mutex every poll, so the flag the game
+// thread checks every frame gets a line of its own. The game thread's frame
+// counters are in hot::g_hook.
+struct alignas(cache_line_size) Dormancy {
+    std::mutex mutex;
+    bool dormant = false;
+    uint32_t config_version = 0;
+    int64_t dormant_since = 0;
+    int64_t dormant_ticks = 0;
+    uint64_t flips = 0;
+
+    // Set when a probe wakes the hook
+    alignas(cache_line_size) std::atomic<bool> probing = false;
+
+    void on_frame(bool stored, uint32_t version);
+    void wake(bool probe);
+    void enter(uint32_t version);
+    auto dormant_ms() -> double;
+};
+
+auto g_dormancy = Dormancy {};
+auto g_dormancy_thread = worker::Thread {};
+
+void Dormancy::on_frame(bool stored, uint32_t version) {
+    auto& hook = hot::g_hook;
+    // Loaded first, so most frames don't write to the line.
+    if (this->probing.load(std::memory_order_relaxed) && this->probing.exchange(false)) {
+        if (stored) {
+            hook.backoff = std::min<uint32_t>(hook.backoff * 2, dormant_max_backoff);
+        } else {
+            hook.backoff = std::max<uint32_t>(hook.backoff / 2, 1);
+            this->enter(version);
+            return;
+        }
+    }
+    if (stored) {
+        hook.stable_frames = 0;
+        return;
+    }
+    if (++hook.stable_frames >= dormant_after_frames * hook.backoff) this->enter(version);
+}
+
+void Dormancy::enter(uint32_t version) {
+    hot::g_hook.stable_frames = 0;
+    if (!g_dormancy_thread.is_running()) return; // nothing would wake the hook
+    auto const lock = std::scoped_lock {this->mutex};
+    if (this->dormant || !set_update_hook_enabled(false)) return;
+    this->dormant = true;
+    this->config_version = version;
+    this->dormant_since = query_performance_counter();
+    ++this->flips;
+}
+
+void Dormancy::wake(bool probe) {
+    auto const lock = std::scoped_lock {this->mutex};
+    if (!this->dormant) return;
+    this->probing.store(probe);
+    if (!set_update_hook_enabled(true)) {
+        LOGLINE(ERR) << "Failed to re-enable the camera update hook!";
+        return;
+    }
+    this->dormant = false;
+    this->dormant_ticks += query_performance_counter() - this->dormant_since;
+    ++this->flips;
+}
+
+auto Dormancy::dormant_ms() -> double {
+    auto const lock = std::scoped_lock {this->mutex};
+    auto ticks = this->dormant_ticks;
+    if (this->dormant) ticks += query_performance_counter() - this->dormant_since;
+    return ticks * 1000.0 / query_performance_frequency();
+}
+
+void watch_dormancy(HANDLE stop_event) {
+    while (WaitForSingleObject(stop_event, dormancy_poll_ms) == WAIT_TIMEOUT) {
+        auto const version = config::ReadSection {}.snapshot().version;
+        auto wake = optional<bool> {};
+        {
+            auto const lock = std::scoped_lock {g_dormancy.mutex};
+            if (!g_dormancy.dormant) continue;
+            auto const elapsed_ms = (query_performance_counter() - g_dormancy.dormant_since) * 1000.0
+                / query_performance_frequency();
+            if (version != g_dormancy.config_version || api::has_callbacks()) wake = false;
+            else if (elapsed_ms >= dormant_probe_ms) wake = true;
+        }
+        if (wake.has_value()) g_dormancy.wake(*wake);
+    }
+}
+
+void start_dormancy() {
+    g_dormancy_thread.start("dormancy", watch_dormancy);
+}
+
+void stop_dormancy() {
+    g_dormancy_thread.stop();
+    LOGLINE(DEBUG) << "Update hook was dormant for " << g_dormancy.dormant_ms() / 1000 << " s over "
+        << g_dormancy.flips << " flips.";
+}
 
 void hook_init_camera(uintptr_t camera, int camera_id) {
+    ZONE("hook_init_camera");
     config::reload_config();
     g_init_camera_hook.call(camera, camera_id);
-    camera::update(camera);
+    {
+        auto const section = config::ReadSection {};
+        auto const capture = trace::Scope {camera, section.snapshot().version};
+        camera::update(camera, section.snapshot());
+    }
+    api::dispatch();
+    g_dormancy.wake(false);
 }
 
-void hook_update_camera(uintptr_t camera, uintptr_t view_param, uintptr_t interp_param, float param4) {
+void reload_config_from_hook() {
+    auto const budget = watchdog::Scope {};
+    auto const profile = profiler::Scope {profiler::Stage::ReloadConfig};
+    auto guard = alloc_guard::Scope {profiler::Stage::ReloadConfig};
+    auto const checked = alloc_guard::is_enabled();
+    auto const version = checked ? config::ReadSection {}.snapshot().version : 0;
     config::reload_config();
-    g_update_camera_hook.call(camera, view_param, interp_param, param4);
-    camera::update(camera);
+    // Loading a new config allocates, which is not steady state.
+    if (checked && config::ReadSection {}.snapshot().version != version) guard.dismiss();
+}
+
+void update_camera_from_hook(uintptr_t camera) {
+    auto stored = false;
+    auto version = uint32_t {0};
+    {
+        auto const budget = watchdog::Scope {};
+        auto const profile = profiler::Scope {profiler::Stage::Update};
+        auto const guard = alloc_guard::Scope {profiler::Stage::Update};
+        auto const section = config::ReadSection {};
+        auto const capture = trace::Scope {camera, section.snapshot().version};
+        stored = camera::update(camera, section.snapshot());
+        version = section.snapshot().version;
+    }
+    api::dispatch();
+    // Outside the guard, since the first flip of a hook allocates its trap.
+    // Registered callbacks expect every frame, so they keep the hook awake,
+    // unless the hooks keep running over their budget.
+    if (watchdog::end_call()) g_dormancy.enter(version);
+    else g_dormancy.on_frame(stored || api::has_callbacks(), version);
+}
+
+void hook_update_camera(uintptr_t camera, uintptr_t view_param, uintptr_t interp_param, float param4) {
+    ZONE("hook_update_camera");
+    reload_config_from_hook();
+    {
+        auto const profile = profiler::Scope {profiler::Stage::Trampoline};
+        g_update_camera_hook.call(camera, view_param, interp_param, param4);
+    }
+    update_camera_from_hook(camera);
+}
+
+auto read_register(safetyhook::Context const& context, uint8_t index) -> uintptr_t {
+    switch (index) {
+        case 0: return context.rax;
+        case 1: return context.rcx;
+        case 2: return context.rdx;
+        case 3: return context.rbx;
+        case 4: return context.rsp;
+        case 5: return context.rbp;
+        case 6: return context.rsi;
+        case 7: return context.rdi;
+        case 8: return context.r8;
+        case 9: return context.r9;
+        case 10: return context.r10;
+        case 11: return context.r11;
+        case 12: return context.r12;
+        case 13: return context.r13;
+        case 14: return context.r14;
+        case 15: return context.r15;
+    }
+    return 0;
+}
+
+// Runs inside the update function, right after its last store to the view
+// params, while the camera is still in the register that store used.
+void hook_update_params(safetyhook::Context& context) {
+    ZONE("hook_update_params");
+    reload_config_from_hook();
+    update_camera_from_hook(read_register(context, hot::g_hook.params_register));
 }
 
 constexpr auto init_camera_bytes = std::to_array<uint8_t>({
@@ -37,8 +243,36 @@ constexpr auto update_camera_bytes = std::to_array<uint8_t>({
     0x48, 0x81, 0xEC, 0x90, 0x00, 0x00, 0x00, 0x48, 0x8B, 0xD9,
 });
 
+// The prologues alone are far from unique, so also require the init function
+// to access the camera ID field, and the update function to store the shift
+// and fov fields of the view params.
+constexpr auto init_camera_displacements = std::to_array({camera::camera_id_offset});
+constexpr auto update_camera_displacements = std::to_array({
+    camera::params_offset + camera::params_field_offsets.front(),
+    camera::params_offset + camera::params_field_offsets.back(),
+});
+
+constexpr auto update_camera_body_size = size_t {0x1000};
+
+constexpr auto init_camera_signature = scanner::Signature {
+    .name = "init_camera",
+    .pattern = { .bytes = init_camera_bytes },
+    .displacements = init_camera_displacements,
+};
+
+constexpr auto update_camera_signature = scanner::Signature {
+    .name = "update_camera",
+    .pattern = { .bytes = update_camera_bytes },
+    .displacements = update_camera_displacements,
+    .body_size = update_camera_body_size,
+};
+
+auto matches_bytes(uintptr_t target, std::span<uint8_t const> bytes) -> bool {
+    return std::equal(bytes.begin(), bytes.end(), reinterpret_cast<uint8_t const*>(target));
+}
+
 auto check_bytes(uintptr_t target, std::span<uint8_t const> bytes) -> bool {
-    if (!std::equal(bytes.begin(), bytes.end(), reinterpret_cast<uint8_t const*>(target))) {
+    if (!matches_bytes(target, bytes)) {
         LOGLINE(ERR) << "Function at 0x" << std::hex << target << " does not match expected bytes!";
         return false;
     }
@@ -49,6 +283,13 @@ struct Targets {
     uintptr_t init_camera_addr;
     uintptr_t update_camera_addr;
 
+    auto operator==(Targets const&) const -> bool = default;
+
+    auto matches() const -> bool {
+        return matches_bytes(this->init_camera_addr, init_camera_bytes)
+            && matches_bytes(this->update_camera_addr, update_camera_bytes);
+    }
+
     auto check() const -> bool {
         return check_bytes(this->init_camera_addr, init_camera_bytes)
             && check_bytes(this->update_camera_addr, update_camera_bytes);
@@ -60,101 +301,219 @@ constexpr auto targets_421810 = Targets {
     .update_camera_addr = 0x141fa6be0
 };
 
+auto scan_targets() -> optional<Targets> {
+    auto const init_camera_addr = scanner::find_unique(init_camera_signature);
+    auto const update_camera_addr = scanner::find_unique(update_camera_signature);
+    if (!init_camera_addr || !update_camera_addr) return std::nullopt;
+    return Targets {
+        .init_camera_addr = *init_camera_addr,
+        .update_camera_addr = *update_camera_addr,
+    };
+}
+
+auto resolve_targets() -> optional<Targets> {
+    auto const known_targets = targets_421810;
+    auto const scanned_targets = scan_targets();
+    if (scanned_targets.has_value()) {
+        if (*scanned_targets == known_targets || !known_targets.matches()) return scanned_targets;
+        // A known build where the signatures found something else
+        LOGLINE(WARN) << "Signature scan disagrees with known addresses, using known addresses.";
+        return known_targets;
+    }
+    LOGLINE(WARN) << "Signature scan failed, falling back to known addresses.";
+    if (!known_targets.check()) return std::nullopt;
+    return known_targets;
+}
+
+auto image_base() -> uintptr_t {
+    return reinterpret_cast<uintptr_t>(GetModuleHandleW(nullptr));
+}
+
+// Whether size bytes at rva lie within the game's image, so a corrupt cache
+// entry is never dereferenced.
+auto is_within_image(uint64_t rva, size_t size) -> bool {
+    auto const nt_headers = scanner::main_module_headers();
+    if (nt_headers == nullptr) return false;
+    auto const image_size = uint64_t {nt_headers->OptionalHeader.SizeOfImage};
+    return rva <= image_size && size <= image_size - rva;
+}
+
+auto load_cached_targets() -> optional<Targets> {
+    auto const entry = address_cache::load();
+    if (!entry.has_value()) return std::nullopt;
+    auto const in_bounds = is_within_image(entry->init_camera_rva, init_camera_bytes.size())
+        && is_within_image(entry->update_camera_rva, update_camera_bytes.size());
+    if (!in_bounds) {
+        LOGLINE(WARN) << "Cached addresses are outside of the game's image, rescanning.";
+        return std::nullopt;
+    }
+    auto const targets = Targets {
+        .init_camera_addr = image_base() + entry->init_camera_rva,
+        .update_camera_addr = image_base() + entry->update_camera_rva,
+    };
+    auto const layout = camera_layout::Layout {
+        .params_offset = entry->params_offset,
+        .camera_id_offset = entry->camera_id_offset,
+    };
+    auto const valid = layout == camera_layout::known && targets.matches();
+    if (!valid) {
+        LOGLINE(DEBUG) << "Cached addresses do not match, rescanning.";
+        return std::nullopt;
+    }
+    LOGLINE(DEBUG) << "Using cached addresses, last scan took " << entry->last_scan_ms << " ms.";
+    return targets;
+}
+
+void store_cached_targets(Targets const& targets, camera_layout::Layout const& layout, double scan_ms) {
+    auto const identity = address_cache::current_identity();
+    if (!identity.has_value()) return;
+    address_cache::store(address_cache::Entry {
+        .identity = *identity,
+        .init_camera_rva = targets.init_camera_addr - image_base(),
+        .update_camera_rva = targets.update_camera_addr - image_base(),
+        .params_offset = layout.params_offset,
+        .camera_id_offset = layout.camera_id_offset,
+        .last_scan_ms = scan_ms,
+    });
+}
+
 auto get_targets() -> optional<Targets> {
     if (!config::is_supported_version()) {
         LOGLINE(ERR) << "Unsupported game version!";
         return std::nullopt;
     }
-    auto const targets = targets_421810;
-    if (!targets.check()) return std::nullopt;
+    auto const cached_targets = load_cached_targets();
+    if (cached_targets.has_value()) return cached_targets;
+
+    auto const start = query_performance_counter();
+    auto const targets = resolve_targets();
+    if (!targets.has_value()) return std::nullopt;
+    auto const layout = camera_layout::discover(targets->init_camera_addr, targets->update_camera_addr);
+    auto const scan_ms = (query_performance_counter() - start) * 1000.0 / query_performance_frequency();
+    LOGLINE(DEBUG) << "Signature scan took " << scan_ms << " ms.";
+    // camera::update is compiled for the known offsets
+    if (!layout) {
+        LOGLINE(ERR) << "Could not verify the camera fields, not hooking!";
+        return std::nullopt;
+    }
+    if (*layout != camera_layout::known) {
+        LOGLINE(ERR) << "Camera fields moved (view params at 0x" << std::hex << layout->params_offset
+                     << ", camera ID at 0x" << layout->camera_id_offset << "), not hooking!";
+        return std::nullopt;
+    }
+    store_cached_targets(*targets, *layout, scan_ms);
     return targets;
 }
 
-void log_safetyhook_allocator_error(std::stringstream &line, safetyhook::Allocator::Error const& error) {
-    line << "An error occurred when allocating memory: ";
-    switch (error) {
-        case safetyhook::Allocator::Error::BAD_VIRTUAL_ALLOC:
-            line << "VirtualAlloc failed.";
-            break;
-        case safetyhook::Allocator::Error::NO_MEMORY_IN_RANGE:
-            line << "No memory in range.";
-            break;
-        default:
-            line << "Unknown allocator error.";
-            break;
+auto find_params_site(uintptr_t update_camera_addr) -> optional<scanner::StoreSite> {
+    auto const site = scanner::find_last_store(
+        update_camera_addr, update_camera_body_size, camera::params_fields_begin, camera::params_fields_end
+    );
+    if (!site) LOGLINE(INFO) << "View param store not found, hooking the whole update function.";
+    return site;
+}
+
+auto create_hooks(Targets const& targets) -> bool {
+    ZONE("create_hooks");
+    auto const [init_camera_addr, update_camera_addr] = targets;
+    if (auto const site = find_params_site(update_camera_addr)) {
+        LOGLINE(DEBUG) << "Hooking view param store at 0x" << std::hex << site->address << '.';
+        hot::g_hook.params_register = site->base_register;
+        auto const installed = g_hooks
+            .add(init_camera_addr, reinterpret_cast<void*>(hook_init_camera), g_init_camera_hook)
+            .add(site->next_address, hook_update_params, g_update_params_hook)
+            .install();
+        if (installed) return true;
+        LOGLINE(WARN) << "Falling back to hooking the whole update function.";
     }
+    return g_hooks
+        .add(init_camera_addr, reinterpret_cast<void*>(hook_init_camera), g_init_camera_hook)
+        .add(update_camera_addr, reinterpret_cast<void*>(hook_update_camera), g_update_camera_hook)
+        .install();
 }
 
-void log_safetyhook_error(SafetyHookInline::Error const& error) {
-    auto line = std::stringstream {};
-    auto log_instruction_pointer = [&](uint8_t *ip) {
-        line << " (IP @ 0x" << std::hex << reinterpret_cast<uintptr_t>(ip) << ')';
-    };
-    switch (error.type) {
-        case SafetyHookInline::Error::BAD_ALLOCATION:
-            log_safetyhook_allocator_error(line, error.allocator_error);
-            break;
+void reset_hooks() {
+    LOGLINE(INFO) << "Resetting hooks...";
+    g_hooks.reset();
+}
 
-        case SafetyHookInline::Error::FAILED_TO_DECODE_INSTRUCTION:
-            line << "Failed to decode an instruction.";
-            log_instruction_pointer(error.ip);
-            break;
+void start_services() {
+    zones::start();
+    trace::start(); // before the watcher publishes the first config
+    watcher::start();
+    if (MinLogLevel <= DEBUG) camera_log::start();
+    profiler::start();
+}
 
-        case SafetyHookInline::Error::SHORT_JUMP_IN_TRAMPOLINE:
-            line << "The trampoline contains a short jump.";
-            log_instruction_pointer(error.ip);
-            break;
+// The watcher and poller publish config snapshots, which may reopen the
+// telemetry segment and the trace capture, so they are stopped first.
+void stop_services() {
+    profiler::stop();
+    camera_log::stop();
+    camera::flush_log();
+    watcher::stop();
+    trace::stop();
+    telemetry::stop();
+    zones::stop();
+}
 
-        case SafetyHookInline::Error::IP_RELATIVE_INSTRUCTION_OUT_OF_RANGE:
-            line << "An IP - relative instruction is out of range.";
-            log_instruction_pointer(error.ip);
-            break;
+// Installing hooks suspends the game's threads and scans the executable, so
+// it runs on its own thread instead of under the loader lock in DllMain.
+enum class InitState { Pending, Installing, Ready, Failed, Cancelled };
 
-        case SafetyHookInline::Error::UNSUPPORTED_INSTRUCTION_IN_TRAMPOLINE:
-            line << "An unsupported instruction was found in the trampoline.";
-            log_instruction_pointer(error.ip);
-            break;
+constexpr auto init_slow_ms = 1000.0;
 
-        case SafetyHookInline::Error::FAILED_TO_UNPROTECT:
-            line << "Failed to unprotect memory.";
-            log_instruction_pointer(error.ip);
-            break;
+auto g_init_thread = worker::Thread {};
+auto g_init_state = std::atomic<InitState> {InitState::Pending};
 
-        case SafetyHookInline::Error::NOT_ENOUGH_SPACE:
-            line << "Not enough space to create the hook.";
-            log_instruction_pointer(error.ip);
-            break;
+auto is_cancelled(HANDLE stop_event) -> bool {
+    return stop_event != nullptr && WaitForSingleObject(stop_event, 0) == WAIT_OBJECT_0;
+}
 
-        default:
-            line << "Unknown safetyhook error.";
-            break;
-    }
-    LOGLINE(ERR) << line.view();
+auto attach(HANDLE stop_event) -> InitState {
+    start_services();
+    auto const targets = get_targets();
+    if (!targets) return InitState::Failed;
+    if (is_cancelled(stop_event)) return InitState::Cancelled;
+    if (!create_hooks(*targets)) return InitState::Failed;
+    start_dormancy();
+    return InitState::Ready;
 }
 
-auto create_hook(uintptr_t target, void* destination, SafetyHookInline &hook) -> bool {
-    auto result = SafetyHookInline::create(target, destination);
-    if (!result) {
-        LOGLINE(ERR) << "Failed to create hook for function at 0x" << std::hex << target << '!';
-        log_safetyhook_error(result.error());
-        return false;
+void initialize(HANDLE stop_event) {
+    g_init_state.store(InitState::Installing);
+    auto const start = query_performance_counter();
+    auto const state = attach(stop_event);
+    auto const elapsed_ms = (query_performance_counter() - start) * 1000.0 / query_performance_frequency();
+    if (state != InitState::Ready) {
+        reset_hooks();
+        stop_services();
     }
-    hook = std::move(*result);
-    return true;
-}
+    g_init_state.store(state);
 
-auto create_hooks() -> bool {
-    auto const targets = get_targets();
-    if (!targets) return false;
-    auto const [init_camera_addr, update_camera_addr] = *targets;
-    return create_hook(init_camera_addr, hook_init_camera, g_init_camera_hook)
-        && create_hook(update_camera_addr, hook_update_camera, g_update_camera_hook);
+    switch (state) {
+        case InitState::Ready:
+            LOGLINE(INFO) << "Success!";
+            break;
+        case InitState::Cancelled:
+            LOGLINE(INFO) << "Attaching was cancelled.";
+            return;
+        default:
+            LOGLINE(ERR) << "Failed to attach plugin!";
+            return;
+    }
+    if (elapsed_ms > init_slow_ms) LOGLINE(WARN) << "Installing hooks took " << elapsed_ms << " ms.";
 }
 
-void reset_hooks() {
-    LOGLINE(INFO) << "Resetting hooks...";
-    g_init_camera_hook.reset();
-    g_update_camera_hook.reset();
+// Keeps the plugin mapped until the process exits, for hooks or threads that
+// may still run its code after it is detached.
+void pin_module() {
+    auto module = HMODULE {};
+    auto const pinned = GetModuleHandleExW(
+        GET_MODULE_HANDLE_EX_FLAG_PIN | GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+        reinterpret_cast<LPCWSTR>(&pin_module), &module
+    );
+    if (!pinned) LOGLINE(ERR) << "Failed to pin the plugin (error " << GetLastError() << ")!";
 }
 
 } /* unnamed namespace */
@@ -163,12 +522,22 @@ BOOL APIENTRY DllMain(HMODULE module, DWORD reason, LPVOID lpReserved) {
     switch (reason) {
         case DLL_PROCESS_ATTACH: {
             LOGLINE(INFO) << "Attaching plugin...";
-            if (!create_hooks()) return false;
-            LOGLINE(INFO) << "Success!";
-            break;
+            if (g_init_thread.start("init", initialize)) break;
+            initialize(nullptr);
+            return g_init_state.load() == InitState::Ready;
         }
         case DLL_PROCESS_DETACH: {
-            reset_hooks();
+            g_init_thread.stop(); // cancels an install still in progress
+            if (g_init_thread.is_running()) {
+                LOGLINE(WARN) << "Hooks are still being installed, keeping the plugin loaded.";
+                pin_module();
+                break;
+            }
+            if (g_init_state.load() == InitState::Ready) {
+                stop_dormancy();
+                reset_hooks();
+                stop_services();
+            }
             LOGLINE(INFO) << "Plugin detached.";
             break;
         }
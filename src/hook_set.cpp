@@ -0,0 +1,341 @@
+#include "hook_set.hpp"
+
+#include "shared.hpp"
+
+#include "safetyhook.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <tlhelp32.h>
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <vector>
+
+namespace hooks {
+
+namespace /* unnamed */ {
+
+constexpr auto arena_reserve_size = size_t {0x1000};
+constexpr auto page_size = uintptr_t {0x1000};
+
+constexpr auto thread_access = DWORD {THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_SET_CONTEXT};
+
+// Suspends every other thread of the process for as long as it lives. Code
+// running under the freeze must not allocate or log, since a suspended
+// thread may be holding the heap lock.
+class ThreadFreeze {
+public:
+    ThreadFreeze();
+    ~ThreadFreeze();
+    ThreadFreeze(ThreadFreeze const&) = delete;
+    auto operator=(ThreadFreeze const&) -> ThreadFreeze& = delete;
+
+    auto size() const -> size_t;
+    // Moves threads stopped inside [from, from + len) to the same offset in to.
+    void redirect(uint8_t* from, uint8_t* to, size_t len);
+
+private:
+    struct Frozen {
+        HANDLE handle;
+        CONTEXT context;
+        bool modified;
+    };
+
+    std::vector<Frozen> threads = {};
+};
+
+ThreadFreeze::ThreadFreeze() {
+    auto const snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        LOGLINE(WARN) << "Failed to enumerate threads (error " << GetLastError() << ").";
+        return;
+    }
+    auto const process_id = GetCurrentProcessId();
+    auto const thread_id = GetCurrentThreadId();
+    auto handles = std::vector<HANDLE> {};
+    auto entry = THREADENTRY32 {};
+    entry.dwSize = sizeof(entry);
+    for (auto found = Thread32First(snapshot, &entry); found; found = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != process_id || entry.th32ThreadID == thread_id) continue;
+        auto const handle = OpenThread(thread_access, FALSE, entry.th32ThreadID);
+        if (handle != nullptr) handles.push_back(handle);
+    }
+    CloseHandle(snapshot);
+
+    this->threads.reserve(handles.size());
+    for (auto const handle : handles) {
+        if (SuspendThread(handle) == DWORD(-1)) {
+            CloseHandle(handle);
+            continue;
+        }
+        auto& thread = this->threads.emplace_back();
+        thread.handle = handle;
+        // Also waits for the suspension to take effect.
+        thread.context.ContextFlags = CONTEXT_CONTROL;
+        if (!GetThreadContext(handle, &thread.context)) thread.context.ContextFlags = 0;
+    }
+}
+
+ThreadFreeze::~ThreadFreeze() {
+    for (auto& thread : this->threads) {
+        if (thread.modified) SetThreadContext(thread.handle, &thread.context);
+        ResumeThread(thread.handle);
+        CloseHandle(thread.handle);
+    }
+}
+
+auto ThreadFreeze::size() const -> size_t {
+    return this->threads.size();
+}
+
+void ThreadFreeze::redirect(uint8_t* from, uint8_t* to, size_t len) {
+    for (auto& thread : this->threads) {
+        if (thread.context.ContextFlags == 0) continue;
+        auto const ip = reinterpret_cast<uint8_t*>(thread.context.Rip);
+        if (ip < from || ip >= from + len) continue;
+        thread.context.Rip = reinterpret_cast<uintptr_t>(to + (ip - from));
+        thread.modified = true;
+    }
+}
+
+// enable() and disable() register a trap for their patch window on first
+// use, which allocates. Register both here, before any thread is frozen.
+void register_traps(SafetyHookInline const& hook) {
+    auto const target = hook.target();
+    auto const trampoline = hook.trampoline().data();
+    auto const len = hook.original_bytes().size();
+    safetyhook::trap_threads(target, trampoline, len, {});
+    safetyhook::trap_threads(trampoline, target, len, {});
+}
+
+void log_safetyhook_allocator_error(std::stringstream &line, safetyhook::Allocator::Error const& error) {
+    line << "An error occurred when allocating memory: ";
+    switch (error) {
+        case safetyhook::Allocator::Error::BAD_VIRTUAL_ALLOC:
+            line << "VirtualAlloc failed.";
+            break;
+        case safetyhook::Allocator::Error::NO_MEMORY_IN_RANGE:
+            line << "No memory in range.";
+            break;
+        default:
+            line << "Unknown allocator error.";
+            break;
+    }
+}
+
+void log_safetyhook_error(SafetyHookInline::Error const& error) {
+    auto line = std::stringstream {};
+    auto log_instruction_pointer = [&](uint8_t *ip) {
+        line << " (IP @ 0x" << std::hex << reinterpret_cast<uintptr_t>(ip) << ')';
+    };
+    switch (error.type) {
+        case SafetyHookInline::Error::BAD_ALLOCATION:
+            log_safetyhook_allocator_error(line, error.allocator_error);
+            break;
+
+        case SafetyHookInline::Error::FAILED_TO_DECODE_INSTRUCTION:
+            line << "Failed to decode an instruction.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        case SafetyHookInline::Error::SHORT_JUMP_IN_TRAMPOLINE:
+            line << "The trampoline contains a short jump.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        case SafetyHookInline::Error::IP_RELATIVE_INSTRUCTION_OUT_OF_RANGE:
+            line << "An IP - relative instruction is out of range.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        case SafetyHookInline::Error::UNSUPPORTED_INSTRUCTION_IN_TRAMPOLINE:
+            line << "An unsupported instruction was found in the trampoline.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        case SafetyHookInline::Error::FAILED_TO_UNPROTECT:
+            line << "Failed to unprotect memory.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        case SafetyHookInline::Error::NOT_ENOUGH_SPACE:
+            line << "Not enough space to create the hook.";
+            log_instruction_pointer(error.ip);
+            break;
+
+        default:
+            line << "Unknown safetyhook error.";
+            break;
+    }
+    LOGLINE(ERR) << line.view();
+}
+
+// Maps one block in range of every target before any hook is created, so
+// the trampolines share it instead of each searching for memory on its own.
+// The reservation is returned right away; the allocator keeps the block.
+void reserve_arena(safetyhook::Allocator& allocator, std::vector<uint8_t*> const& targets) {
+    auto const reservation = allocator.allocate_near(targets, arena_reserve_size);
+    if (!reservation) LOGLINE(WARN) << "Failed to reserve trampoline memory near all hooks.";
+}
+
+void log_arena_usage(std::span<SafetyHookInline const* const> hooks) {
+    auto used = size_t {0};
+    auto pages = std::vector<uintptr_t> {};
+    for (auto const hook : hooks) {
+        auto const start = hook->trampoline().address();
+        auto const end = start + hook->trampoline().size();
+        used += end - start;
+        for (auto page = start & ~(page_size - 1); page < end; page += page_size) {
+            if (!std::ranges::contains(pages, page)) pages.push_back(page);
+        }
+    }
+    LOGLINE(DEBUG) << "Trampolines use " << used << " bytes in " << pages.size() << " page(s).";
+}
+
+auto prepare_hook(
+    std::shared_ptr<safetyhook::Allocator> const& allocator, uintptr_t target, void* destination, SafetyHookInline &hook
+) -> bool {
+    auto result = SafetyHookInline::create(allocator, target, destination, SafetyHookInline::StartDisabled);
+    if (!result) {
+        LOGLINE(ERR) << "Failed to create hook for function at 0x" << std::hex << target << '!';
+        log_safetyhook_error(result.error());
+        return false;
+    }
+    hook = std::move(*result);
+    register_traps(hook);
+    return true;
+}
+
+void log_safetyhook_error(SafetyHookMid::Error const& error) {
+    switch (error.type) {
+        case SafetyHookMid::Error::BAD_ALLOCATION: {
+            auto line = std::stringstream {};
+            log_safetyhook_allocator_error(line, error.allocator_error);
+            LOGLINE(ERR) << line.view();
+            break;
+        }
+        case SafetyHookMid::Error::BAD_INLINE_HOOK:
+            log_safetyhook_error(error.inline_hook_error);
+            break;
+        default:
+            LOGLINE(ERR) << "Unknown safetyhook error.";
+            break;
+    }
+}
+
+auto prepare_hook(
+    std::shared_ptr<safetyhook::Allocator> const& allocator, uintptr_t target, safetyhook::MidHookFn destination,
+    SafetyHookMid &hook
+) -> bool {
+    auto result = SafetyHookMid::create(allocator, target, destination, SafetyHookMid::StartDisabled);
+    if (!result) {
+        LOGLINE(ERR) << "Failed to create mid-function hook at 0x" << std::hex << target << '!';
+        log_safetyhook_error(result.error());
+        return false;
+    }
+    hook = std::move(*result);
+    return true;
+}
+
+} /* unnamed namespace */
+
+HookSet::HookSet(std::shared_ptr<safetyhook::Allocator> allocator) : allocator {std::move(allocator)} {}
+
+auto HookSet::add(uintptr_t target, void* destination, SafetyHookInline& hook) -> HookSet& {
+    this->entries.push_back({target, destination, &hook});
+    return *this;
+}
+
+auto HookSet::add(uintptr_t target, safetyhook::MidHookFn destination, SafetyHookMid& hook) -> HookSet& {
+    this->mid_entries.push_back({target, destination, &hook});
+    return *this;
+}
+
+auto HookSet::install() -> bool {
+    auto targets = std::vector<uint8_t*> {};
+    for (auto const& entry : this->entries) targets.push_back(reinterpret_cast<uint8_t*>(entry.target));
+    for (auto const& entry : this->mid_entries) targets.push_back(reinterpret_cast<uint8_t*>(entry.target));
+    reserve_arena(*this->allocator, targets);
+    auto const prepare = [&](auto const& entry) {
+        return prepare_hook(this->allocator, entry.target, entry.destination, *entry.hook);
+    };
+    if (!std::ranges::all_of(this->entries, prepare) || !std::ranges::all_of(this->mid_entries, prepare)) {
+        this->reset();
+        return false;
+    }
+
+    // MidHook does not expose the trampoline of its inline hook, so threads
+    // cannot be moved out of its patch under the freeze. Mid-function hooks
+    // are enabled first, each within its own trap window.
+    for (auto const& entry : this->mid_entries) {
+        auto const result = entry.hook->enable();
+        if (!result) {
+            LOGLINE(ERR) << "Failed to enable mid-function hook at 0x" << std::hex << entry.target << '!';
+            log_safetyhook_error(result.error());
+            this->reset();
+            return false;
+        }
+    }
+
+    auto failed = std::optional<size_t> {};
+    auto error = SafetyHookInline::Error {};
+    auto suspended = size_t {0};
+    {
+        auto freeze = ThreadFreeze {};
+        suspended = freeze.size();
+        for (auto i = size_t {0}; i < this->entries.size() && !failed; ++i) {
+            auto const result = this->entries[i].hook->enable();
+            if (!result) {
+                failed = i;
+                error = result.error();
+            }
+        }
+        for (auto const& entry : this->entries) {
+            auto& hook = *entry.hook;
+            if (failed) {
+                static_cast<void>(hook.disable());
+            } else {
+                freeze.redirect(hook.target(), hook.trampoline().data(), hook.original_bytes().size());
+            }
+        }
+    }
+
+    if (failed) {
+        LOGLINE(ERR) << "Failed to enable hook for function at 0x" << std::hex << this->entries[*failed].target << '!';
+        log_safetyhook_error(error);
+        this->reset();
+        return false;
+    }
+    LOGLINE(DEBUG) << "Installed " << this->entries.size() + this->mid_entries.size() << " hooks with "
+        << suspended << " threads suspended.";
+    if (MinLogLevel <= DEBUG) {
+        auto hooks = std::vector<SafetyHookInline const*> {};
+        for (auto const& entry : this->entries) hooks.push_back(entry.hook);
+        log_arena_usage(hooks);
+    }
+    return true;
+}
+
+void HookSet::reset() {
+    auto const is_enabled = [](Entry const& entry) { return entry.hook->enabled(); };
+    if (std::ranges::any_of(this->entries, is_enabled)) {
+        auto freeze = ThreadFreeze {};
+        for (auto const& entry : this->entries) {
+            auto& hook = *entry.hook;
+            if (!hook.enabled()) continue;
+            static_cast<void>(hook.disable());
+            freeze.redirect(hook.trampoline().data(), hook.target(), hook.original_bytes().size());
+        }
+    }
+    for (auto const& entry : this->mid_entries) static_cast<void>(entry.hook->disable());
+    // Freeing the trampolines takes the allocator's lock, so do it after resuming.
+    for (auto const& entry : this->entries) entry.hook->reset();
+    for (auto const& entry : this->mid_entries) entry.hook->reset();
+    this->entries.clear();
+    this->mid_entries.clear();
+}
+
+} /* namespace hooks */
@@ -0,0 +1,49 @@
+#ifndef MHWORLD_CUSTOM_FOV_HOOK_SET_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_HOOK_SET_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include "safetyhook.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace hooks {
+
+// Inline hooks that are installed and removed together. Trampolines are
+// prepared first, then every target is patched while the game's other
+// threads are suspended once, so either all hooks go live or none do.
+// All trampolines are taken from one allocator, near every target.
+// Mid-function hooks are enabled just before the freeze, one at a time.
+class HookSet {
+public:
+    explicit HookSet(std::shared_ptr<safetyhook::Allocator> allocator);
+    HookSet(HookSet const&) = delete;
+    auto operator=(HookSet const&) -> HookSet& = delete;
+
+    auto add(uintptr_t target, void* destination, SafetyHookInline& hook) -> HookSet&;
+    auto add(uintptr_t target, safetyhook::MidHookFn destination, SafetyHookMid& hook) -> HookSet&;
+    auto install() -> bool;
+    void reset();
+
+private:
+    struct Entry {
+        uintptr_t target;
+        void* destination;
+        SafetyHookInline* hook;
+    };
+
+    struct MidEntry {
+        uintptr_t target;
+        safetyhook::MidHookFn destination;
+        SafetyHookMid* hook;
+    };
+
+    std::shared_ptr<safetyhook::Allocator> allocator;
+    std::vector<Entry> entries = {};
+    std::vector<MidEntry> mid_entries = {};
+};
+
+} /* namespace hooks */
+
+#endif /* include guard */
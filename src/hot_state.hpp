@@ -0,0 +1,51 @@
+#ifndef MHWORLD_CUSTOM_FOV_HOT_STATE_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_HOT_STATE_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace hot {
+
+// State the camera hooks touch on every frame, gathered on one cache line
+// of its own. Only the camera hook thread writes it, except for the feature
+// switches, which change when a config snapshot is published. State that
+// other threads write often stays in its module, on padded lines.
+struct alignas(cache_line_size) HookState {
+    // See is_enabled() of each module
+    std::atomic<bool> profile_hooks = false;
+    std::atomic<bool> check_allocations = false;
+    std::atomic<bool> publish_telemetry = false;
+    std::atomic<bool> capture_trace = false;
+    std::atomic<bool> watch_budget = false;
+    // Set before the hooks are installed, or by the watchdog on the camera
+    // hook thread
+    bool background_reload = false;
+    uint8_t params_register = 0;
+    uint8_t shed_level = 0; // see watchdog::Level
+
+    // camera::update statistics
+    Counter memo_hits = {};
+    Counter memo_misses = {};
+    Counter skipped_stores = {};
+    Counter evicted_cameras = {};
+
+    // Frames until the update hook goes dormant, see Dormancy in dllmain.cpp
+    uint32_t stable_frames = 0;
+    uint32_t backoff = 1;
+
+    // Hook call budget, see watchdog.hpp
+    uint32_t call_ticks = 0;
+    uint32_t budget_ticks = 0;
+    uint16_t window_calls = 0;
+    uint16_t window_overruns = 0;
+};
+
+static_assert(sizeof(HookState) == cache_line_size, "per-frame state must fit a single cache line");
+
+inline auto g_hook = HookState {};
+
+} /* namespace hot */
+
+#endif /* include guard */
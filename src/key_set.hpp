@@ -0,0 +1,57 @@
+#ifndef MHWORLD_CUSTOM_FOV_KEY_SET_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_KEY_SET_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Set of string keys behind a perfect hash, built at compile time. Lookups
+// hash the key once and compare it against a single slot.
+template <size_t Count>
+class KeySet {
+public:
+    consteval explicit KeySet(std::array<string_view, Count> const& keys) {
+        for (auto seed = uint32_t {1}; seed <= max_seed; ++seed) {
+            if (this->try_seed(keys, seed)) return;
+        }
+        this->seed = 0;
+    }
+
+    // False if no seed without collisions was found.
+    constexpr auto is_perfect() const -> bool { return this->seed != 0; }
+
+    constexpr auto contains(string_view key) const -> bool {
+        return !key.empty() && this->slots[slot_of(key, this->seed)] == key;
+    }
+
+private:
+    static constexpr auto slot_count = std::bit_ceil(Count) * 4;
+    static constexpr auto slot_bits = std::countr_zero(slot_count);
+    static constexpr auto max_seed = uint32_t {4096};
+
+    // FNV-1a, keeping the top bits, which mix best
+    static constexpr auto slot_of(string_view key, uint32_t seed) -> size_t {
+        auto hash = uint32_t {2166136261u} ^ seed;
+        for (auto const c : key) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        return hash >> (32 - slot_bits);
+    }
+
+    constexpr auto try_seed(std::array<string_view, Count> const& keys, uint32_t seed) -> bool {
+        this->slots = {};
+        for (auto const key : keys) {
+            auto& slot = this->slots[slot_of(key, seed)];
+            if (!slot.empty()) return false;
+            slot = key;
+        }
+        this->seed = seed;
+        return true;
+    }
+
+    uint32_t seed = 0;
+    std::array<string_view, slot_count> slots = {};
+};
+
+#endif /* include guard */
@@ -0,0 +1,154 @@
+#include "profiler.hpp"
+
+#include "shared.hpp"
+#include "worker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iomanip>
+#include <utility>
+
+namespace profiler {
+
+namespace /* unnamed */ {
+
+// Log-scale buckets: exact below 16 ticks, then 4 buckets per power of two,
+// which keeps the relative error of a percentile below 25%.
+constexpr auto linear_buckets = uint64_t {16};
+constexpr auto sub_bucket_bits = 2;
+constexpr auto bucket_count = size_t {256};
+
+constexpr
+auto bucket_index(uint64_t ticks) -> size_t {
+    if (ticks < linear_buckets) return static_cast<size_t>(ticks);
+    auto const octave = std::bit_width(ticks) - 1;
+    auto const sub_bucket = (ticks >> (octave - sub_bucket_bits)) & ((1 << sub_bucket_bits) - 1);
+    return linear_buckets + ((octave - 4) << sub_bucket_bits) + sub_bucket;
+}
+
+constexpr
+auto bucket_upper_bound(size_t index) -> uint64_t {
+    if (index < linear_buckets) return index;
+    auto const octave = ((index - linear_buckets) >> sub_bucket_bits) + 4;
+    auto const sub_bucket = (index - linear_buckets) & ((1 << sub_bucket_bits) - 1);
+    auto const width = uint64_t {1} << (octave - sub_bucket_bits);
+    return ((1 << sub_bucket_bits) + sub_bucket) * width + width - 1;
+}
+
+static_assert(bucket_index(~uint64_t {0}) == bucket_count - 1);
+static_assert(bucket_upper_bound(bucket_index(1000)) >= 1000);
+static_assert(bucket_upper_bound(bucket_index(1000) - 1) < 1000);
+
+// Starts a cache line, since the reporting thread writes max.
+struct alignas(cache_line_size) Histogram {
+    std::array<Counter, bucket_count> buckets = {};
+    std::atomic<uint64_t> max = 0; // reset by the reporting thread
+};
+
+using Counts = std::array<uint64_t, bucket_count>;
+
+auto g_histograms = std::array<Histogram, stage_count> {};
+auto g_interval_seconds = std::atomic<int64_t> {60};
+auto g_thread = worker::Thread {};
+
+constexpr auto stage_names = std::to_array<string_view>({
+    "reload_config", "trampoline", "update", "store",
+});
+
+// TSC frequency, measured against the performance counter over the whole
+// time profiling has been running.
+struct Calibration {
+    uint64_t tsc = __rdtsc();
+    int64_t qpc = query_performance_counter();
+
+    auto ns_per_tick() const -> double {
+        auto const elapsed_ns = static_cast<double>(query_performance_counter() - this->qpc)
+            * 1'000'000'000 / query_performance_frequency();
+        auto const elapsed_ticks = static_cast<double>(__rdtsc() - this->tsc);
+        return elapsed_ticks > 0 ? elapsed_ns / elapsed_ticks : 0.0;
+    }
+};
+
+auto g_calibration = Calibration {};
+auto g_reported = std::array<Counts, stage_count> {};
+
+auto percentile(Counts const& counts, uint64_t total, double fraction) -> uint64_t {
+    auto const rank = static_cast<uint64_t>(fraction * (total - 1));
+    auto seen = uint64_t {0};
+    for (auto index = size_t {0}; index < bucket_count; ++index) {
+        seen += counts[index];
+        if (seen > rank) return bucket_upper_bound(index);
+    }
+    return bucket_upper_bound(bucket_count - 1);
+}
+
+void report() {
+    auto const ns_per_tick = g_calibration.ns_per_tick();
+    auto const to_ns = [&](uint64_t ticks) { return static_cast<uint64_t>(ticks * ns_per_tick); };
+    for (auto stage = size_t {0}; stage < stage_count; ++stage) {
+        auto& histogram = g_histograms[stage];
+        auto& reported = g_reported[stage];
+        auto counts = Counts {};
+        auto total = uint64_t {0};
+        for (auto index = size_t {0}; index < bucket_count; ++index) {
+            auto const count = histogram.buckets[index].get();
+            counts[index] = count - reported[index];
+            reported[index] = count;
+            total += counts[index];
+        }
+        auto const max = histogram.max.exchange(0, std::memory_order_relaxed);
+        if (total == 0) continue;
+        LOGLINE(INFO) << std::setw(13) << stage_names[stage] << " (ns)"
+            << " p50 " << to_ns(percentile(counts, total, 0.50))
+            << " p90 " << to_ns(percentile(counts, total, 0.90))
+            << " p99 " << to_ns(percentile(counts, total, 0.99))
+            << " max " << to_ns(max)
+            << " n " << total;
+    }
+}
+
+void run(HANDLE stop_event) {
+    auto last_report = query_performance_counter();
+    while (WaitForSingleObject(stop_event, 1000) == WAIT_TIMEOUT) {
+        auto const interval = g_interval_seconds.load(std::memory_order_relaxed) * query_performance_frequency();
+        if (query_performance_counter() - last_report < interval) continue;
+        last_report = query_performance_counter();
+        report();
+    }
+}
+
+} /* unnamed namespace */
+
+void configure(bool enabled, int64_t interval_seconds) {
+    g_interval_seconds.store(std::max<int64_t>(interval_seconds, 1), std::memory_order_relaxed);
+    if (enabled != is_enabled()) LOGLINE(INFO) << "Hook profiling " << (enabled ? "enabled." : "disabled.");
+    hot::g_hook.profile_hooks.store(enabled, std::memory_order_relaxed);
+}
+
+auto ns_per_tick() -> double {
+    return g_calibration.ns_per_tick();
+}
+
+auto start() -> bool {
+    return g_thread.start("profiler", run);
+}
+
+void stop() {
+    g_thread.stop();
+    if (!g_thread.is_running()) report();
+}
+
+void record(Stage stage, uint64_t ticks) {
+    auto& histogram = g_histograms[std::to_underlying(stage)];
+    histogram.buckets[bucket_index(ticks)].add();
+    if (ticks > histogram.max.load(std::memory_order_relaxed)) {
+        histogram.max.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+} /* namespace profiler */
+
+auto as_str(profiler::Stage stage) -> string_view {
+    return profiler::stage_names[std::to_underlying(stage)];
+}
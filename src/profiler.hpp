@@ -0,0 +1,54 @@
+#ifndef MHWORLD_CUSTOM_FOV_PROFILER_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_PROFILER_HPP_INCLUDED
+
+#include "hot_state.hpp"
+#include "shared.hpp"
+
+#include <intrin.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace profiler {
+
+enum class Stage { ReloadConfig, Trampoline, Update, Store };
+constexpr auto stage_count = size_t {4};
+
+inline
+auto is_enabled() -> bool {
+    return hot::g_hook.profile_hooks.load(std::memory_order_relaxed);
+}
+
+void configure(bool enabled, int64_t interval_seconds);
+
+// Length of a TSC tick, measured over the time since the plugin was loaded.
+auto ns_per_tick() -> double;
+
+// Report percentiles on a background thread every configured interval, and
+// once more when stopped.
+auto start() -> bool;
+void stop();
+
+// Only call from the camera hook thread.
+void record(Stage stage, uint64_t ticks);
+
+// Times its own lifetime in TSC ticks. Costs a single relaxed load while
+// profiling is disabled.
+class Scope {
+public:
+    explicit Scope(Stage stage) : stage(stage), start(is_enabled() ? __rdtsc() : 0) {}
+    ~Scope() { if (this->start != 0) record(this->stage, __rdtsc() - this->start); }
+    Scope(Scope const&) = delete;
+    auto operator=(Scope const&) -> Scope& = delete;
+
+private:
+    Stage stage;
+    uint64_t start;
+};
+
+} /* namespace profiler */
+
+auto as_str(profiler::Stage stage) -> string_view;
+
+#endif /* include guard */
@@ -0,0 +1,421 @@
+#include "scanner.hpp"
+
+#include "shared.hpp"
+
+#include "Zydis.h"
+
+#include <intrin.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace scanner {
+
+namespace /* unnamed */ {
+
+auto is_significant(Pattern const& pattern, size_t index) -> bool {
+    return pattern.mask.empty() || pattern.mask[index] != 0;
+}
+
+auto matches_at(uint8_t const* data, Pattern const& pattern) -> bool {
+    for (auto index = size_t {0}; index < pattern.bytes.size(); ++index) {
+        if (is_significant(pattern, index) && data[index] != pattern.bytes[index]) return false;
+    }
+    return true;
+}
+
+// Two significant bytes, as far apart as possible, used to filter candidate
+// positions before comparing the whole pattern.
+struct Anchors {
+    size_t first;
+    size_t last;
+};
+
+auto find_anchors(Pattern const& pattern) -> optional<Anchors> {
+    auto anchors = optional<Anchors> {};
+    for (auto index = size_t {0}; index < pattern.bytes.size(); ++index) {
+        if (!is_significant(pattern, index)) continue;
+        if (!anchors.has_value()) anchors = Anchors { .first = index, .last = index };
+        anchors->last = index;
+    }
+    return anchors;
+}
+
+auto has_avx2() -> bool {
+    static auto const supported = [] {
+        auto registers = std::array<int, 4> {};
+        __cpuidex(registers.data(), 1, 0);
+        auto const os_saves_ymm = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        if (!os_saves_ymm) return false;
+        __cpuidex(registers.data(), 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+}
+
+// Each returns the first position it did not check.
+using ScanFunction = auto (*)(std::span<uint8_t const>, Pattern const&, Anchors, void*, detail::MatchFunction) -> size_t;
+
+auto scan_avx2(std::span<uint8_t const> region, Pattern const& pattern, Anchors anchors,
+    void* context, detail::MatchFunction on_match) -> size_t
+{
+    constexpr auto width = size_t {32};
+    auto const first = _mm256_set1_epi8(static_cast<char>(pattern.bytes[anchors.first]));
+    auto const last = _mm256_set1_epi8(static_cast<char>(pattern.bytes[anchors.last]));
+    auto const end = region.size() - pattern.bytes.size() + 1;
+    auto position = size_t {0};
+    for (; position + anchors.last + width <= region.size() && position + width <= end; position += width) {
+        auto const* data = region.data() + position;
+        auto const first_block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + anchors.first));
+        auto const last_block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + anchors.last));
+        auto const candidates = _mm256_and_si256(_mm256_cmpeq_epi8(first_block, first), _mm256_cmpeq_epi8(last_block, last));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(candidates));
+        while (mask != 0) {
+            auto const offset = position + std::countr_zero(mask);
+            if (matches_at(region.data() + offset, pattern)) on_match(context, offset);
+            mask &= mask - 1;
+        }
+    }
+    _mm256_zeroupper();
+    return position;
+}
+
+auto scan_sse2(std::span<uint8_t const> region, Pattern const& pattern, Anchors anchors,
+    void* context, detail::MatchFunction on_match) -> size_t
+{
+    constexpr auto width = size_t {16};
+    auto const first = _mm_set1_epi8(static_cast<char>(pattern.bytes[anchors.first]));
+    auto const last = _mm_set1_epi8(static_cast<char>(pattern.bytes[anchors.last]));
+    auto const end = region.size() - pattern.bytes.size() + 1;
+    auto position = size_t {0};
+    for (; position + anchors.last + width <= region.size() && position + width <= end; position += width) {
+        auto const* data = region.data() + position;
+        auto const first_block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + anchors.first));
+        auto const last_block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + anchors.last));
+        auto const candidates = _mm_and_si128(_mm_cmpeq_epi8(first_block, first), _mm_cmpeq_epi8(last_block, last));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(candidates));
+        while (mask != 0) {
+            auto const offset = position + std::countr_zero(mask);
+            if (matches_at(region.data() + offset, pattern)) on_match(context, offset);
+            mask &= mask - 1;
+        }
+    }
+    return position;
+}
+
+auto references_displacement(uint8_t const* body, size_t body_size, uint32_t displacement) -> bool {
+    auto bytes = std::array<uint8_t, sizeof(displacement)> {};
+    std::memcpy(bytes.data(), &displacement, sizeof(displacement));
+    return !std::ranges::search(std::span {body, body_size}, bytes).empty();
+}
+
+// Bytes after a hook site that must not be branch targets, enough for the
+// longest jump safetyhook may write there.
+constexpr auto hook_patch_size = uintptr_t {14};
+
+auto written_memory_operand(ZydisDecodedInstruction const& instruction, ZydisDecodedOperand const* operands)
+    -> ZydisDecodedOperand const* {
+    for (auto i = 0; i < instruction.operand_count_visible; ++i) {
+        auto const& operand = operands[i];
+        if (operand.type == ZYDIS_OPERAND_TYPE_MEMORY && (operand.actions & ZYDIS_OPERAND_ACTION_MASK_WRITE) != 0) {
+            return &operand;
+        }
+    }
+    return nullptr;
+}
+
+// Base register of a store to [base + displacement] with a displacement in
+// [begin, end), or none.
+auto store_base_register(ZydisDecodedInstruction const& instruction, ZydisDecodedOperand const* operands,
+    uint32_t begin, uint32_t end) -> ZydisRegister {
+    auto const operand = written_memory_operand(instruction, operands);
+    if (operand == nullptr || operand->mem.index != ZYDIS_REGISTER_NONE) return ZYDIS_REGISTER_NONE;
+    auto const displacement = operand->mem.disp.value;
+    if (displacement < begin || displacement >= end) return ZYDIS_REGISTER_NONE;
+    if (ZydisRegisterGetClass(operand->mem.base) != ZYDIS_REGCLASS_GPR64) return ZYDIS_REGISTER_NONE;
+    if (operand->mem.base == ZYDIS_REGISTER_RSP) return ZYDIS_REGISTER_NONE;
+    return operand->mem.base;
+}
+
+auto branch_target(ZydisDecodedInstruction const& instruction, ZydisDecodedOperand const* operands, uintptr_t address)
+    -> optional<uintptr_t> {
+    if ((instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE) == 0 || instruction.operand_count_visible == 0) {
+        return std::nullopt;
+    }
+    if (operands[0].type != ZYDIS_OPERAND_TYPE_IMMEDIATE) return std::nullopt;
+    auto target = ZyanU64 {};
+    if (!ZYAN_SUCCESS(ZydisCalcAbsoluteAddress(&instruction, &operands[0], address, &target))) return std::nullopt;
+    return target;
+}
+
+struct Instruction {
+    uintptr_t address;
+    uintptr_t next_address;
+    ZydisDecodedInstruction const& instruction;
+    ZydisDecodedOperand const* operands;
+};
+
+// Decodes the first size bytes of function in order, and calls on_instruction
+// for each instruction until the function ends or on_instruction returns
+// false. Returns the branch targets seen, or nothing if it was stopped.
+template <typename Function>
+auto decode_function(uintptr_t function, size_t size, Function&& on_instruction) -> optional<std::vector<uintptr_t>> {
+    auto decoder = ZydisDecoder {};
+    if (!ZYAN_SUCCESS(ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64))) {
+        return std::nullopt;
+    }
+
+    auto branch_targets = std::vector<uintptr_t> {};
+    auto furthest_target = uintptr_t {0};
+    auto instruction = ZydisDecodedInstruction {};
+    auto operands = std::array<ZydisDecodedOperand, ZYDIS_MAX_OPERAND_COUNT> {};
+    for (auto offset = size_t {0}; offset < size; offset += instruction.length) {
+        auto const address = function + offset;
+        auto const bytes = reinterpret_cast<void const*>(address);
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, bytes, size - offset, &instruction, operands.data()))) {
+            break;
+        }
+        auto const next_address = address + instruction.length;
+        if (instruction.mnemonic == ZYDIS_MNEMONIC_INT3) break; // padding after the function
+        auto const target = branch_target(instruction, operands.data(), address);
+        if (target.has_value()) {
+            branch_targets.push_back(*target);
+            if (*target < function + size) furthest_target = std::max<uintptr_t>(furthest_target, *target);
+        }
+        // A return or jump that no earlier branch skips over ends the function.
+        auto const is_exit = instruction.mnemonic == ZYDIS_MNEMONIC_RET || instruction.mnemonic == ZYDIS_MNEMONIC_JMP;
+        if (is_exit && next_address > furthest_target) break;
+
+        auto const decoded = Instruction {
+            .address = address,
+            .next_address = next_address,
+            .instruction = instruction,
+            .operands = operands.data(),
+        };
+        if (!on_instruction(decoded)) return std::nullopt;
+    }
+    return branch_targets;
+}
+
+// General purpose registers that still hold an argument, followed through
+// register moves at least as wide as the argument. Ignores branches, so it
+// is only an estimate, but a register the argument was copied to before the
+// first branch and that is never written after it holds the argument on
+// every path.
+class ArgumentRegisters {
+public:
+    explicit ArgumentRegisters(ZydisRegister argument = ZYDIS_REGISTER_RCX)
+        : mask {bit(argument)}, width {width_of(argument)} {}
+
+    auto contains(ZydisRegister reg) const -> bool {
+        return this->is_wide_enough(reg) && (this->mask & bit(reg)) != 0;
+    }
+
+    // Only meaningful once the whole function was decoded.
+    auto holds_on_every_path(ZydisRegister reg) const -> bool {
+        if (!this->branched) return this->contains(reg);
+        return this->is_wide_enough(reg) && (this->pinned & bit(reg)) != 0;
+    }
+
+    void update(ZydisDecodedInstruction const& instruction, ZydisDecodedOperand const* operands) {
+        if (!this->branched && is_branch(instruction)) {
+            this->branched = true;
+            this->pinned = this->mask;
+        }
+        if (instruction.mnemonic == ZYDIS_MNEMONIC_CALL) {
+            this->clear(volatile_mask);
+            return;
+        }
+        auto const is_copy = instruction.mnemonic == ZYDIS_MNEMONIC_MOV
+            && operands[0].type == ZYDIS_OPERAND_TYPE_REGISTER
+            && this->is_wide_enough(operands[0].reg.value)
+            && operands[1].type == ZYDIS_OPERAND_TYPE_REGISTER
+            && this->contains(operands[1].reg.value);
+        if (is_copy) {
+            this->pinned &= ~bit(operands[0].reg.value);
+            this->mask |= bit(operands[0].reg.value);
+            return;
+        }
+        for (auto i = 0; i < instruction.operand_count; ++i) {
+            auto const& operand = operands[i];
+            auto const writes = (operand.actions & ZYDIS_OPERAND_ACTION_MASK_WRITE) != 0;
+            if (operand.type != ZYDIS_OPERAND_TYPE_REGISTER || !writes) continue;
+            if (is_gpr(operand.reg.value)) this->clear(bit(operand.reg.value));
+        }
+    }
+
+private:
+    static auto enclosing(ZydisRegister reg) -> ZydisRegister {
+        return ZydisRegisterGetLargestEnclosing(ZYDIS_MACHINE_MODE_LONG_64, reg);
+    }
+
+    static auto is_gpr(ZydisRegister reg) -> bool {
+        return ZydisRegisterGetClass(enclosing(reg)) == ZYDIS_REGCLASS_GPR64;
+    }
+
+    static auto width_of(ZydisRegister reg) -> ZyanU16 {
+        return ZydisRegisterGetWidth(ZYDIS_MACHINE_MODE_LONG_64, reg);
+    }
+
+    // For any register within the same general purpose register
+    static auto bit(ZydisRegister reg) -> uint16_t {
+        return static_cast<uint16_t>(1u << ZydisRegisterGetId(enclosing(reg)));
+    }
+
+    auto is_wide_enough(ZydisRegister reg) const -> bool {
+        return is_gpr(reg) && width_of(reg) >= this->width;
+    }
+
+    static auto is_branch(ZydisDecodedInstruction const& instruction) -> bool {
+        auto const category = instruction.meta.category;
+        return category == ZYDIS_CATEGORY_COND_BR || category == ZYDIS_CATEGORY_UNCOND_BR
+            || category == ZYDIS_CATEGORY_RET;
+    }
+
+    void clear(uint16_t bits) {
+        this->mask &= ~bits;
+        this->pinned &= ~bits;
+    }
+
+    // rax, rcx, rdx and r8 to r11, which calls may overwrite
+    static constexpr auto volatile_mask = uint16_t {0x0f07};
+
+    uint16_t mask;
+    ZyanU16 width;
+    uint16_t pinned = 0;
+    bool branched = false;
+};
+
+} /* unnamed namespace */
+
+void detail::scan(std::span<uint8_t const> region, Pattern const& pattern, void* context, MatchFunction on_match) {
+    auto const anchors = find_anchors(pattern);
+    if (!anchors.has_value() || region.size() < pattern.bytes.size()) return;
+    auto const scan_vectorized = has_avx2() ? ScanFunction {scan_avx2} : ScanFunction {scan_sse2};
+    auto const end = region.size() - pattern.bytes.size() + 1;
+    for (auto position = scan_vectorized(region, pattern, *anchors, context, on_match); position < end; ++position) {
+        if (matches_at(region.data() + position, pattern)) on_match(context, position);
+    }
+}
+
+auto main_module_headers() -> IMAGE_NT_HEADERS64 const* {
+    auto const base = reinterpret_cast<uint8_t const*>(GetModuleHandleW(nullptr));
+    auto const& dos_header = *reinterpret_cast<IMAGE_DOS_HEADER const*>(base);
+    if (dos_header.e_magic != IMAGE_DOS_SIGNATURE) return nullptr;
+    auto const nt_headers = reinterpret_cast<IMAGE_NT_HEADERS64 const*>(base + dos_header.e_lfanew);
+    if (nt_headers->Signature != IMAGE_NT_SIGNATURE) return nullptr;
+    return nt_headers;
+}
+
+auto executable_sections() -> std::vector<std::span<uint8_t const>> {
+    auto const base = reinterpret_cast<uint8_t const*>(GetModuleHandleW(nullptr));
+    auto const nt_headers = main_module_headers();
+    if (nt_headers == nullptr) return {};
+
+    auto sections = std::vector<std::span<uint8_t const>> {};
+    auto const first_section = IMAGE_FIRST_SECTION(nt_headers);
+    for (auto index = WORD {0}; index < nt_headers->FileHeader.NumberOfSections; ++index) {
+        auto const& section = first_section[index];
+        if ((section.Characteristics & IMAGE_SCN_MEM_EXECUTE) == 0) continue;
+        sections.emplace_back(base + section.VirtualAddress, section.Misc.VirtualSize);
+    }
+    return sections;
+}
+
+auto find_last_store(uintptr_t function, size_t size, uint32_t begin, uint32_t end) -> optional<StoreSite> {
+    auto site = optional<StoreSite> {};
+    auto base_register = ZydisRegister {ZYDIS_REGISTER_NONE};
+    auto registers = ArgumentRegisters {};
+    auto const branch_targets = decode_function(function, size, [&](Instruction const& decoded) {
+        auto const store_base = store_base_register(decoded.instruction, decoded.operands, begin, end);
+        if (store_base == ZYDIS_REGISTER_NONE) {
+            registers.update(decoded.instruction, decoded.operands);
+            return true;
+        }
+        if (base_register != ZYDIS_REGISTER_NONE && store_base != base_register) {
+            LOGLINE(WARN) << "Stores at 0x" << std::hex << function << " use more than one base register.";
+            return false;
+        }
+        // The hook hands this register to camera::update as the camera.
+        if (!registers.contains(store_base)) {
+            LOGLINE(WARN) << "Store at 0x" << std::hex << decoded.address << " is not based on the camera.";
+            return false;
+        }
+        registers.update(decoded.instruction, decoded.operands);
+        base_register = store_base;
+        site = StoreSite {
+            .address = decoded.address,
+            .next_address = decoded.next_address,
+            .base_register = static_cast<uint8_t>(ZydisRegisterGetId(base_register)),
+        };
+        return true;
+    });
+
+    if (!branch_targets.has_value() || !site.has_value()) return std::nullopt;
+    if (!registers.holds_on_every_path(base_register)) {
+        LOGLINE(WARN) << "Register of the store at 0x" << std::hex << site->address
+                      << " may not hold the camera on every path.";
+        return std::nullopt;
+    }
+    auto const lands_in_patch = [&](uintptr_t target) {
+        return target > site->next_address && target < site->next_address + hook_patch_size;
+    };
+    if (std::ranges::any_of(*branch_targets, lands_in_patch)) {
+        LOGLINE(WARN) << "A branch lands inside the hook site at 0x" << std::hex << site->next_address << '.';
+        return std::nullopt;
+    }
+    return site;
+}
+
+auto find_field_accesses(uintptr_t function, size_t size) -> std::vector<FieldAccess> {
+    auto accesses = std::vector<FieldAccess> {};
+    auto registers = ArgumentRegisters {};
+    auto second_argument = ArgumentRegisters {ZYDIS_REGISTER_EDX};
+    decode_function(function, size, [&](Instruction const& decoded) {
+        auto const& source = decoded.operands[1];
+        auto const copies_second_argument = decoded.instruction.mnemonic == ZYDIS_MNEMONIC_MOV
+            && source.type == ZYDIS_OPERAND_TYPE_REGISTER && second_argument.contains(source.reg.value);
+        for (auto i = 0; i < decoded.instruction.operand_count_visible; ++i) {
+            auto const& operand = decoded.operands[i];
+            if (operand.type != ZYDIS_OPERAND_TYPE_MEMORY || operand.mem.type != ZYDIS_MEMOP_TYPE_MEM) continue;
+            if (operand.mem.index != ZYDIS_REGISTER_NONE || !registers.contains(operand.mem.base)) continue;
+            auto const displacement = operand.mem.disp.value;
+            if (displacement < 0 || displacement > std::numeric_limits<uint32_t>::max()) continue;
+            auto const writes = (operand.actions & ZYDIS_OPERAND_ACTION_MASK_WRITE) != 0;
+            accesses.push_back(FieldAccess {
+                .displacement = static_cast<uint32_t>(displacement),
+                .size = static_cast<uint8_t>(operand.size / 8),
+                .writes = writes,
+                .stores_second_argument = writes && copies_second_argument,
+            });
+        }
+        registers.update(decoded.instruction, decoded.operands);
+        second_argument.update(decoded.instruction, decoded.operands);
+        return true;
+    });
+    return accesses;
+}
+
+auto find_unique(Signature const& signature) -> optional<uintptr_t> {
+    auto match = optional<uintptr_t> {};
+    auto match_count = size_t {0};
+    for (auto const section : executable_sections()) {
+        scan(section, signature.pattern, [&](size_t offset) {
+            auto const body_size = std::min(signature.body_size, section.size() - offset);
+            auto const references_fields = std::ranges::all_of(signature.displacements, [&](uint32_t displacement) {
+                return references_displacement(section.data() + offset, body_size, displacement);
+            });
+            if (!references_fields) return;
+            match = reinterpret_cast<uintptr_t>(section.data() + offset);
+            ++match_count;
+        });
+    }
+    if (match_count == 1) return match;
+    LOGLINE(WARN) << "Found " << match_count << " matches for " << signature.name << " signature.";
+    return std::nullopt;
+}
+
+} /* namespace scanner */
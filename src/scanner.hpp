@@ -0,0 +1,85 @@
+#ifndef MHWORLD_CUSTOM_FOV_SCANNER_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_SCANNER_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace scanner {
+
+// Byte pattern, where a zero mask byte marks a wildcard. An empty mask
+// makes every byte significant.
+struct Pattern {
+    std::span<uint8_t const> bytes;
+    std::span<uint8_t const> mask = {};
+};
+
+// A function is identified by its prologue, plus displacements of struct
+// fields it is known to access within its first body_size bytes.
+struct Signature {
+    string_view name;
+    Pattern pattern;
+    std::span<uint32_t const> displacements = {};
+    size_t body_size = 0x200;
+};
+
+// Headers of the game's executable, or nullptr if they look invalid.
+auto main_module_headers() -> IMAGE_NT_HEADERS64 const*;
+auto executable_sections() -> std::vector<std::span<uint8_t const>>;
+
+// Calls on_match for every position in region that matches the pattern.
+template <typename Function>
+void scan(std::span<uint8_t const> region, Pattern const& pattern, Function&& on_match);
+
+// Returns the address of the only match in the executable sections of the
+// game's main module, if there is exactly one.
+auto find_unique(Signature const& signature) -> optional<uintptr_t>;
+
+// Store to [base + displacement] within a function, found by decoding its
+// instructions. base_register is the GPR index, 0 for rax up to 15 for r15.
+struct StoreSite {
+    uintptr_t address;
+    uintptr_t next_address;
+    uint8_t base_register;
+};
+
+// Returns the last store to a displacement in [begin, end) within the first
+// size bytes of function. All such stores must share one base register, which
+// must hold the function's first argument on every path, and no branch may
+// land just after the last one, so it is safe to hook there.
+auto find_last_store(uintptr_t function, size_t size, uint32_t begin, uint32_t end) -> optional<StoreSite>;
+
+// Access to [base + displacement] within a function, where base holds the
+// function's first argument, found by following it from rcx through moves.
+// A store can also be of the 32 bit second argument, followed from edx.
+struct FieldAccess {
+    uint32_t displacement;
+    uint8_t size;
+    bool writes;
+    bool stores_second_argument;
+};
+
+// Returns the field accesses within the first size bytes of function, in
+// order.
+auto find_field_accesses(uintptr_t function, size_t size) -> std::vector<FieldAccess>;
+
+namespace detail {
+
+using MatchFunction = void (*)(void* context, size_t offset);
+void scan(std::span<uint8_t const> region, Pattern const& pattern, void* context, MatchFunction on_match);
+
+} /* namespace detail */
+
+template <typename Function>
+void scan(std::span<uint8_t const> region, Pattern const& pattern, Function&& on_match) {
+    detail::scan(region, pattern, &on_match, [](void* context, size_t offset) {
+        (*static_cast<std::remove_reference_t<Function>*>(context))(offset);
+    });
+}
+
+} /* namespace scanner */
+
+#endif /* include guard */
@@ -3,6 +3,9 @@
 
 #include "loader.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string_view>
 
@@ -13,9 +16,40 @@ using namespace std::literals;
 constexpr auto PLUGIN_NAME = "CustomFOV"sv;
 #define LOGLINE(level) LOG {level} << PLUGIN_NAME << ": "
 
+constexpr auto cache_line_size = size_t {64};
+
 struct Interval {
     float lower = 0.0f;
     float upper = 0.0f;
 };
 
+// Only incremented by a single thread, but can be read from any thread.
+struct Counter {
+    std::atomic<uint64_t> value = 0;
+
+    void add(uint64_t amount = 1) {
+        this->value.store(this->value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    auto get() const -> uint64_t {
+        return this->value.load(std::memory_order_relaxed);
+    }
+};
+
+inline
+auto query_performance_counter() -> int64_t {
+    auto counter = LARGE_INTEGER {};
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+inline
+auto query_performance_frequency() -> int64_t {
+    static auto const frequency = [] {
+        auto frequency = LARGE_INTEGER {};
+        QueryPerformanceFrequency(&frequency);
+        return frequency.QuadPart;
+    }();
+    return frequency;
+}
+
 #endif /* include guard */
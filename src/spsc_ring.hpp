@@ -0,0 +1,49 @@
+#ifndef MHWORLD_CUSTOM_FOV_SPSC_RING_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_SPSC_RING_HPP_INCLUDED
+
+#include "shared.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+// Lock-free ring buffer for exactly one producer and one consumer thread.
+// Each side caches the other side's index, so it only touches the shared
+// cache line when the ring looks full or empty.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+public:
+    auto try_push(T const& value) -> bool {
+        auto const head = this->head.load(std::memory_order_relaxed);
+        if (head - this->cached_tail == Capacity) {
+            this->cached_tail = this->tail.load(std::memory_order_acquire);
+            if (head - this->cached_tail == Capacity) return false;
+        }
+        this->slots[head % Capacity] = value;
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto try_pop() -> optional<T> {
+        auto const tail = this->tail.load(std::memory_order_relaxed);
+        if (tail == this->cached_head) {
+            this->cached_head = this->head.load(std::memory_order_acquire);
+            if (tail == this->cached_head) return std::nullopt;
+        }
+        auto value = this->slots[tail % Capacity];
+        this->tail.store(tail + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    alignas(cache_line_size) std::atomic<size_t> head = 0;
+    size_t cached_tail = 0;
+    alignas(cache_line_size) std::atomic<size_t> tail = 0;
+    size_t cached_head = 0;
+    alignas(cache_line_size) std::array<T, Capacity> slots = {};
+};
+
+#endif /* include guard */
@@ -0,0 +1,118 @@
+#include "telemetry.hpp"
+
+#include "camera.hpp"
+#include "shared.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <utility>
+
+namespace telemetry {
+
+namespace /* unnamed */ {
+
+// Serializes configure() on the thread publishing config with stop().
+auto g_mapping_mutex = std::mutex {};
+auto g_mapping = HANDLE {nullptr};
+auto g_segment = std::atomic<Segment*> {nullptr};
+
+// Brackets a write with the odd and the following even sequence number.
+class WriteSection {
+public:
+    explicit WriteSection(Segment& segment)
+        : sequence(segment.sequence), start(this->sequence.load(std::memory_order_relaxed) | 1) {
+        this->sequence.store(this->start, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    ~WriteSection() { this->sequence.store(this->start + 1, std::memory_order_release); }
+    WriteSection(WriteSection const&) = delete;
+    auto operator=(WriteSection const&) -> WriteSection& = delete;
+
+private:
+    std::atomic_ref<uint32_t> sequence;
+    uint32_t start;
+};
+
+// A segment kept alive by a reader still holds the previous session.
+void reset(Segment& segment) {
+    auto const section = WriteSection {segment};
+    segment.magic = segment_magic;
+    segment.layout_version = layout_version;
+    segment.size = sizeof(Segment);
+    segment.frames = 0;
+    segment.config_version = 0;
+    segment.context = 0;
+    segment.camera_id = 0;
+    segment.stored = 0;
+    segment.input = {};
+    segment.output = {};
+    segment.memo_hits = 0;
+    segment.memo_misses = 0;
+    segment.skipped_stores = 0;
+    segment.evicted_cameras = 0;
+    segment.update_ticks.fill(0);
+    segment.camera_frames.fill(0);
+}
+
+auto open_segment() -> bool {
+    g_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(Segment), segment_name);
+    if (g_mapping == nullptr) {
+        LOGLINE(WARN) << "Failed to create telemetry segment (error " << GetLastError() << ").";
+        return false;
+    }
+    auto* const view = MapViewOfFile(g_mapping, FILE_MAP_WRITE, 0, 0, sizeof(Segment));
+    if (view == nullptr) {
+        LOGLINE(WARN) << "Failed to map telemetry segment (error " << GetLastError() << ").";
+        CloseHandle(g_mapping);
+        g_mapping = nullptr;
+        return false;
+    }
+    auto* const segment = static_cast<Segment*>(view);
+    reset(*segment);
+    g_segment.store(segment, std::memory_order_release);
+    return true;
+}
+
+} /* unnamed namespace */
+
+void configure(bool enabled) {
+    auto const lock = std::scoped_lock {g_mapping_mutex};
+    if (enabled && g_mapping == nullptr && !open_segment()) enabled = false;
+    if (enabled != is_enabled()) LOGLINE(INFO) << "Telemetry " << (enabled ? "enabled." : "disabled.");
+    hot::g_hook.publish_telemetry.store(enabled, std::memory_order_relaxed);
+}
+
+void stop() {
+    auto const lock = std::scoped_lock {g_mapping_mutex};
+    auto* const segment = g_segment.exchange(nullptr);
+    if (segment != nullptr) UnmapViewOfFile(segment);
+    if (g_mapping != nullptr) CloseHandle(g_mapping);
+    g_mapping = nullptr;
+}
+
+void write(Frame const& frame) {
+    auto* const segment = g_segment.load(std::memory_order_acquire);
+    if (segment == nullptr) return;
+    auto const stats = camera::get_stats();
+    auto const tick_bucket = std::min<size_t>(std::bit_width(frame.ticks), tick_bucket_count - 1);
+    auto const camera_index = std::min<size_t>(std::to_underlying(frame.camera_id), camera::camera_id_count);
+
+    auto const section = WriteSection {*segment};
+    ++segment->frames;
+    segment->config_version = frame.config_version;
+    segment->context = static_cast<uint32_t>(frame.context);
+    segment->camera_id = std::to_underlying(frame.camera_id);
+    segment->stored = frame.stored;
+    segment->input = frame.input;
+    segment->output = frame.output;
+    segment->memo_hits = stats.memo_hits;
+    segment->memo_misses = stats.memo_misses;
+    segment->skipped_stores = stats.skipped_stores;
+    segment->evicted_cameras = stats.evicted_cameras;
+    ++segment->update_ticks[tick_bucket];
+    ++segment->camera_frames[camera_index];
+}
+
+} /* namespace telemetry */
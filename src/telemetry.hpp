@@ -0,0 +1,82 @@
+#ifndef MHWORLD_CUSTOM_FOV_TELEMETRY_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_TELEMETRY_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "camera_id.hpp"
+#include "hot_state.hpp"
+#include "shared.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace telemetry {
+
+// Publishes the last camera update in a named shared memory segment, for
+// overlays and capture tools. The camera hook writes it with plain stores,
+// guarded by a sequence number (a seqlock). A reader copies the segment
+// and keeps the copy only if the sequence was even before the copy and
+// unchanged after it, reading the sequence through std::atomic_ref.
+
+constexpr auto segment_name = L"Local\\CustomFOV.Telemetry";
+constexpr auto segment_magic = uint32_t {0x564f4643}; // "CFOV"
+constexpr auto layout_version = uint32_t {1};
+constexpr auto tick_bucket_count = size_t {64};
+
+struct Segment {
+    uint32_t magic;
+    uint32_t layout_version;
+    uint32_t size;                       // sizeof(Segment)
+    uint32_t sequence;                   // odd while a frame is written
+    uint64_t frames;                     // camera updates published so far
+    uint32_t config_version;
+    uint32_t context;                    // camera::Context
+    uint32_t camera_id;
+    uint32_t stored;                     // 1 if the output had to be written
+    camera::Params input;                // as written by the game
+    camera::Params output;               // after adjustment
+    uint64_t memo_hits;
+    uint64_t memo_misses;
+    uint64_t skipped_stores;
+    uint64_t evicted_cameras;
+    // Bucket i counts updates that took less than 2^i TSC ticks, but at
+    // least 2^(i - 1). The last bucket also counts anything longer.
+    std::array<uint64_t, tick_bucket_count> update_ticks;
+    // Updates per camera ID. The last entry counts IDs out of range.
+    std::array<uint64_t, camera::camera_id_count + 1> camera_frames;
+};
+
+static_assert(std::is_standard_layout_v<Segment> && std::is_trivially_copyable_v<Segment>);
+static_assert(std::atomic_ref<uint32_t>::is_always_lock_free);
+
+inline
+auto is_enabled() -> bool {
+    return hot::g_hook.publish_telemetry.load(std::memory_order_relaxed);
+}
+
+// The first time telemetry is enabled, creates the segment, or opens it if a
+// reader kept it alive. It then stays mapped until stop(), since the camera
+// hook may be writing to it. Only call from the thread that publishes config
+// snapshots.
+void configure(bool enabled);
+void stop();
+
+struct Frame {
+    camera::Context context;
+    camera::CameraID camera_id;
+    camera::Params input;
+    camera::Params output;
+    uint32_t config_version;
+    bool stored;
+    uint64_t ticks;
+};
+
+// Only call from the camera hook thread. Does nothing until the segment is
+// mapped.
+void write(Frame const& frame);
+
+} /* namespace telemetry */
+
+#endif /* include guard */
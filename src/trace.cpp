@@ -0,0 +1,197 @@
+#include "trace.hpp"
+
+#include "camera.hpp"
+#include "config.hpp"
+#include "shared.hpp"
+#include "worker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+namespace trace {
+
+namespace /* unnamed */ {
+
+constexpr auto min_records = uint64_t {1024};
+constexpr auto max_records = uint64_t {1} << 24; // 1 GiB
+
+struct Capture {
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    Header* header = nullptr;
+    Record* records = nullptr;
+
+    void append(Record const& record) {
+        auto const written = this->header->written;
+        if (this->header->circular == 0 && written >= this->header->capacity) return;
+        this->records[written % this->header->capacity] = record;
+        this->header->written = written + 1;
+    }
+};
+
+// Opening a capture creates and maps a file of up to 1 GiB, so configure()
+// only hands the settings to the trace thread. The hooks may publish config.
+auto g_thread = worker::Thread {};
+auto g_request_event = HANDLE {nullptr};
+auto g_request_mutex = std::mutex {};
+auto g_requested = Settings {};
+
+// Owned by the trace thread, or by the publishing thread without it
+auto g_settings = Settings {};
+auto g_capture = Capture {};
+
+// The camera hook marks itself as writing before it looks at the current
+// capture, so a capture can only be unmapped once the hook has let go.
+struct alignas(cache_line_size) Shared {
+    std::atomic<Capture*> current = nullptr;
+    std::atomic<bool> writing = false;
+};
+
+auto g_shared = Shared {};
+
+auto get_trace_path() -> optional<std::filesystem::path> {
+    auto const config_path = config::get_config_path();
+    if (!config_path.has_value()) return std::nullopt;
+    return std::filesystem::path {*config_path}.replace_extension(".trace");
+}
+
+void read_param_words(uintptr_t camera_address, std::array<uint32_t, param_word_count>& words) {
+    std::memcpy(words.data(), reinterpret_cast<void const*>(camera_address + camera::params_fields_begin), sizeof(words));
+}
+
+void close_capture() {
+    if (g_capture.header == nullptr) return;
+    hot::g_hook.capture_trace.store(false, std::memory_order_relaxed);
+    g_shared.current.store(nullptr);
+    while (g_shared.writing.load()) YieldProcessor();
+
+    auto const written = g_capture.header->written;
+    FlushViewOfFile(g_capture.header, 0);
+    UnmapViewOfFile(g_capture.header);
+    CloseHandle(g_capture.mapping);
+    CloseHandle(g_capture.file);
+    g_capture = Capture {};
+    LOGLINE(INFO) << "Stopped camera trace after " << written << " frames.";
+}
+
+auto open_capture(Settings const& settings) -> bool {
+    auto const path = get_trace_path();
+    if (!path.has_value()) return false;
+    auto const records = std::clamp(settings.records, min_records, max_records);
+    auto const size = sizeof(Header) + records * sizeof(Record);
+
+    // Shared for reading, so the trace can be copied while the game runs.
+    auto capture = Capture {};
+    capture.file = CreateFileW(path->wstring().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (capture.file == INVALID_HANDLE_VALUE) {
+        LOGLINE(WARN) << "Failed to create camera trace '" << path->string() << "' (error " << GetLastError() << ").";
+        return false;
+    }
+    capture.mapping = CreateFileMappingW(capture.file, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    auto* const view = capture.mapping != nullptr ? MapViewOfFile(capture.mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+    if (view == nullptr) {
+        LOGLINE(WARN) << "Failed to map camera trace '" << path->string() << "' (error " << GetLastError() << ").";
+        if (capture.mapping != nullptr) CloseHandle(capture.mapping);
+        CloseHandle(capture.file);
+        return false;
+    }
+
+    capture.header = static_cast<Header*>(view);
+    capture.records = reinterpret_cast<Record*>(static_cast<std::byte*>(view) + sizeof(Header));
+    *capture.header = Header {
+        .magic = file_magic,
+        .format = file_format,
+        .header_size = sizeof(Header),
+        .record_size = sizeof(Record),
+        .capacity = records,
+        .written = 0,
+        .frequency = query_performance_frequency(),
+        .circular = settings.circular,
+        .reserved = {},
+    };
+    g_capture = capture;
+    g_shared.current.store(&g_capture);
+    hot::g_hook.capture_trace.store(true, std::memory_order_relaxed);
+    LOGLINE(INFO) << "Recording camera trace to '" << path->string() << "' (" << records << " frames"
+        << (settings.circular ? ", circular)." : ").");
+    return true;
+}
+
+void apply(Settings const& settings) {
+    if (settings == g_settings) return;
+    g_settings = settings;
+    close_capture();
+    if (settings.enabled) open_capture(settings);
+}
+
+auto take_request() -> Settings {
+    auto const lock = std::scoped_lock {g_request_mutex};
+    return g_requested;
+}
+
+void run(HANDLE stop_event) {
+    auto const handles = std::to_array({stop_event, g_request_event});
+    auto const count = static_cast<DWORD>(handles.size());
+    while (WaitForMultipleObjects(count, handles.data(), FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+        apply(take_request());
+    }
+}
+
+} /* unnamed namespace */
+
+auto start() -> bool {
+    g_request_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (g_request_event != nullptr && g_thread.start("camera trace", run)) return true;
+    if (g_request_event != nullptr) CloseHandle(g_request_event);
+    g_request_event = nullptr;
+    return false;
+}
+
+void configure(Settings const& settings) {
+    if (!g_thread.is_running()) return apply(settings);
+    {
+        auto const lock = std::scoped_lock {g_request_mutex};
+        if (settings == g_requested) return;
+        g_requested = settings;
+    }
+    SetEvent(g_request_event);
+}
+
+void stop() {
+    g_thread.stop();
+    if (g_thread.is_running()) return; // the thread may still be using the capture
+    if (g_request_event != nullptr) CloseHandle(g_request_event);
+    g_request_event = nullptr;
+    g_requested = Settings {};
+    close_capture();
+    g_settings = Settings {};
+}
+
+auto begin_record(uintptr_t camera_address, uint32_t config_version) -> Record {
+    auto record = Record {
+        .timestamp = query_performance_counter(),
+        .camera_address = camera_address,
+        .camera_id = *reinterpret_cast<uint32_t const*>(camera_address + camera::camera_id_offset),
+        .config_version = config_version,
+        .before = {},
+        .after = {},
+    };
+    read_param_words(camera_address, record.before);
+    return record;
+}
+
+void end_record(Record& record) {
+    read_param_words(record.camera_address, record.after);
+    g_shared.writing.store(true);
+    auto* const capture = g_shared.current.load();
+    if (capture != nullptr) capture->append(record);
+    g_shared.writing.store(false, std::memory_order_release);
+}
+
+} /* namespace trace */
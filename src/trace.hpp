@@ -0,0 +1,99 @@
+#ifndef MHWORLD_CUSTOM_FOV_TRACE_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_TRACE_HPP_INCLUDED
+
+#include "camera.hpp"
+#include "hot_state.hpp"
+#include "shared.hpp"
+#include "watchdog.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace trace {
+
+// Records every camera update into CustomFOV.trace, a memory mapped file
+// of fixed size records that is sized when the capture starts. Recording
+// a frame only stores into the mapping. In circular mode the oldest
+// records are overwritten, so the file always holds the most recent ones.
+
+constexpr auto file_magic = uint32_t {0x52544643}; // "CFTR"
+constexpr auto file_format = uint32_t {1};
+
+// Raw view param words at camera + params_fields_begin, as 32 bit words
+constexpr auto param_word_count = size_t {(camera::params_fields_end - camera::params_fields_begin) / 4};
+
+struct Header {
+    uint32_t magic;
+    uint32_t format;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint64_t capacity;           // records after the header
+    uint64_t written;            // records written, the next goes to written % capacity
+    int64_t frequency;           // performance counter ticks per second
+    uint32_t circular;
+    std::array<uint32_t, 5> reserved;
+};
+
+struct Record {
+    int64_t timestamp;           // performance counter
+    uint64_t camera_address;
+    uint32_t camera_id;
+    uint32_t config_version;
+    std::array<uint32_t, param_word_count> before;
+    std::array<uint32_t, param_word_count> after;
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(Record) == 64);
+
+struct Settings {
+    bool enabled = false;
+    uint64_t records = 0;
+    bool circular = true;
+
+    auto operator==(Settings const&) const -> bool = default;
+};
+
+inline
+auto is_enabled() -> bool {
+    return hot::g_hook.capture_trace.load(std::memory_order_relaxed);
+}
+
+// Opens and closes captures on a background thread, so publishing config
+// from the camera hooks never creates or maps the trace file. Captures are
+// opened directly if the thread is not running.
+auto start() -> bool;
+
+// Starts, restarts or stops the capture when the settings change. Only
+// call from the thread that publishes config snapshots.
+void configure(Settings const& settings);
+
+// Stops the background thread and ends a running capture, flushing the file.
+void stop();
+
+auto begin_record(uintptr_t camera_address, uint32_t config_version) -> Record;
+void end_record(Record& record);
+
+// Records the camera's view params at construction and destruction. Costs
+// a single relaxed load while no capture is running. Frames are skipped
+// while the watchdog sheds the capture.
+class Scope {
+public:
+    Scope(uintptr_t camera_address, uint32_t config_version)
+        : active(is_enabled() && !watchdog::sheds(watchdog::Level::NoTrace))
+    {
+        if (this->active) [[unlikely]] this->record = begin_record(camera_address, config_version);
+    }
+    ~Scope() { if (this->active) [[unlikely]] end_record(this->record); }
+    Scope(Scope const&) = delete;
+    auto operator=(Scope const&) -> Scope& = delete;
+
+private:
+    Record record;
+    bool active;
+};
+
+} /* namespace trace */
+
+#endif /* include guard */
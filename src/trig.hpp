@@ -0,0 +1,69 @@
+#ifndef MHWORLD_CUSTOM_FOV_TRIG_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_TRIG_HPP_INCLUDED
+
+namespace trig {
+
+// Single precision tan and atan for the FOV rescale, using the minimax
+// polynomials of the Cephes library on reduced arguments. Both have a
+// relative error below 3e-7 over their domain. Rescaling a FOV goes through
+// tan three times and atan once, so the projection scale is off by less
+// than 1e-6 relative, and the rescaled FOV by less than
+// 360/pi * (0.5 * 1e-6 + pi/2 * 3e-7) < 1e-4 degrees before it is rounded
+// to a whole degree. The bench's --verify mode checks that the rounded
+// results match std::tan/std::atan for every FOV the game and config use.
+
+constexpr auto pi = 3.14159265358979f;
+constexpr auto half_pi = pi / 2;
+constexpr auto quarter_pi = pi / 4;
+
+// Rounding error of half_pi, so that pi/2 - x stays accurate near pi/2
+constexpr auto half_pi_error = -4.37113883e-8f;
+
+namespace detail {
+
+// tan(x) for x in [0, pi/4]
+constexpr auto tan_kernel(float x) -> float {
+    auto const z = x * x;
+    auto const p = ((((( 9.38540185543e-3f  * z
+                       + 3.11992232697e-3f) * z
+                       + 2.44301354525e-2f) * z
+                       + 5.34112807005e-2f) * z
+                       + 1.33387994085e-1f) * z
+                       + 3.33331568548e-1f);
+    return x + x * z * p;
+}
+
+// atan(x) for x in [-tan(pi/8), tan(pi/8)]
+constexpr auto atan_kernel(float x) -> float {
+    auto const z = x * x;
+    auto const p = ((( 8.05374449538e-2f  * z
+                     - 1.38776856032e-1f) * z
+                     + 1.99777106478e-1f) * z
+                     - 3.33329491539e-1f);
+    return x + x * z * p;
+}
+
+} /* namespace detail */
+
+// Valid for x in [0, pi/2).
+constexpr auto tan(float x) -> float {
+    if (x <= quarter_pi) return detail::tan_kernel(x);
+    return 1.0f / detail::tan_kernel((half_pi - x) + half_pi_error); // exact subtraction
+}
+
+// Valid for x >= 0.
+constexpr auto atan(float x) -> float {
+    constexpr auto tan_3pi_8 = 2.414213562373095f;
+    constexpr auto tan_pi_8 = 0.4142135623730950f;
+    if (x > tan_3pi_8) return half_pi + detail::atan_kernel(-1.0f / x);
+    if (x > tan_pi_8) return quarter_pi + detail::atan_kernel((x - 1.0f) / (x + 1.0f));
+    return detail::atan_kernel(x);
+}
+
+static_assert(tan(0.0f) == 0.0f && atan(0.0f) == 0.0f);
+static_assert(tan(quarter_pi) > 0.9999995f && tan(quarter_pi) < 1.0000005f);
+static_assert(atan(1.0f) > quarter_pi - 1e-6f && atan(1.0f) < quarter_pi + 1e-6f);
+
+} /* namespace trig */
+
+#endif /* include guard */
@@ -0,0 +1,120 @@
+#include "watchdog.hpp"
+
+#include "hot_state.hpp"
+#include "profiler.hpp"
+#include "shared.hpp"
+#include "watcher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <utility>
+
+namespace watchdog {
+
+namespace /* unnamed */ {
+
+constexpr auto max_budget_us = int64_t {1'000'000};
+constexpr auto restore_after_ms = 30'000.0;
+constexpr auto max_level = std::to_underlying(Level::Dormant);
+constexpr auto hook_reload_level = std::to_underlying(Level::NoHookReload);
+
+struct Messages {
+    string_view shed;
+    string_view restore;
+};
+
+constexpr auto level_messages = std::to_array<Messages>({
+    { .shed = "", .restore = "" },
+    { .shed = "no longer logging camera adjustments", .restore = "logging camera adjustments again" },
+    { .shed = "checking the config file from a background thread", .restore = "checking the config file from them again" },
+    { .shed = "pausing the trace capture", .restore = "resuming the trace capture" },
+    { .shed = "putting the update hook to sleep", .restore = "no longer putting the update hook to sleep" },
+});
+
+auto g_budget_us = std::atomic<int64_t> {0};
+
+// Only used by the camera hook thread. A level is restored once no window
+// ran over for restore_after_ms since the last change.
+auto g_last_change = int64_t {0};
+auto g_reload_handed_off = false;
+
+auto to_ticks(int64_t budget_us) -> uint32_t {
+    auto const ns_per_tick = profiler::ns_per_tick();
+    if (ns_per_tick <= 0.0) return 0;
+    auto const ticks = static_cast<double>(budget_us) * 1000.0 / ns_per_tick;
+    return static_cast<uint32_t>(std::min<double>(ticks, std::numeric_limits<uint32_t>::max()));
+}
+
+// Hooks that leave the config file to the watcher have nothing to shed at
+// that level, and without a background thread to poll for them it is skipped
+// as well.
+auto hand_off_reload() -> bool {
+    auto& hook = hot::g_hook;
+    if (hook.background_reload || !watcher::set_background_polling(true)) return false;
+    hook.background_reload = true;
+    g_reload_handed_off = true;
+    return true;
+}
+
+void take_back_reload() {
+    if (!g_reload_handed_off) return;
+    hot::g_hook.background_reload = false;
+    watcher::set_background_polling(false);
+    g_reload_handed_off = false;
+}
+
+} /* unnamed namespace */
+
+void configure(int64_t budget_us) {
+    auto const budget = std::clamp<int64_t>(budget_us, 0, max_budget_us);
+    auto const enabled = budget != 0;
+    if (enabled != is_enabled() || budget != g_budget_us.load(std::memory_order_relaxed)) {
+        if (enabled) LOGLINE(INFO) << "Hook budget set to " << budget << " us.";
+        else LOGLINE(INFO) << "Hook budget disabled.";
+    }
+    g_budget_us.store(budget, std::memory_order_relaxed);
+    hot::g_hook.watch_budget.store(enabled, std::memory_order_relaxed);
+}
+
+auto detail::end_window() -> bool {
+    auto& hook = hot::g_hook;
+    auto const overrun = hook.window_overruns >= overruns_to_shed;
+    hook.window_calls = 0;
+    hook.window_overruns = 0;
+    // Converted every window, since the tick length is measured as it runs.
+    hook.budget_ticks = to_ticks(g_budget_us.load(std::memory_order_relaxed));
+
+    auto const now = query_performance_counter();
+    if (overrun) {
+        g_last_change = now;
+        if (hook.shed_level < max_level) {
+            ++hook.shed_level;
+            if (hook.shed_level == hook_reload_level && !hand_off_reload()) ++hook.shed_level;
+            LOGLINE(WARN) << "Camera hooks keep running over their budget, "
+                << level_messages[hook.shed_level].shed << '.';
+        }
+        return hook.shed_level == max_level;
+    }
+    auto const elapsed_ms = (now - g_last_change) * 1000.0 / query_performance_frequency();
+    if (hook.shed_level != 0 && elapsed_ms >= restore_after_ms) {
+        g_last_change = now;
+        LOGLINE(INFO) << "Camera hooks are back within budget, " << level_messages[hook.shed_level].restore << '.';
+        --hook.shed_level;
+        if (hook.shed_level == hook_reload_level && !g_reload_handed_off) --hook.shed_level;
+        if (hook.shed_level < hook_reload_level) take_back_reload();
+    }
+    return false;
+}
+
+void detail::restore_all() {
+    auto& hook = hot::g_hook;
+    take_back_reload();
+    hook.shed_level = 0;
+    hook.call_ticks = 0;
+    hook.window_calls = 0;
+    hook.window_overruns = 0;
+}
+
+} /* namespace watchdog */
@@ -0,0 +1,89 @@
+#ifndef MHWORLD_CUSTOM_FOV_WATCHDOG_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_WATCHDOG_HPP_INCLUDED
+
+#include "hot_state.hpp"
+#include "shared.hpp"
+
+#include <intrin.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace watchdog {
+
+// Keeps the work of the camera hooks within a time budget per call. While
+// calls keep running over it, work is shed one level at a time, and it is
+// restored one level at a time once calls stay within budget for a while.
+enum class Level : uint8_t {
+    Full,
+    NoDebugLog,   // camera adjustments are not logged
+    NoHookReload, // the config file is polled off the hooks, if they poll it
+    NoTrace,      // frames are not captured
+    Dormant,      // the update hook goes dormant on every overrun
+};
+
+// Calls per window, and overruns within one that shed the next level
+constexpr auto window_calls = uint16_t {60};
+constexpr auto overruns_to_shed = uint16_t {4};
+
+inline
+auto is_enabled() -> bool {
+    return hot::g_hook.watch_budget.load(std::memory_order_relaxed);
+}
+
+// Whether the work of this level is currently shed. Only call from the
+// camera hook thread.
+inline
+auto sheds(Level level) -> bool {
+    return hot::g_hook.shed_level >= std::to_underlying(level);
+}
+
+// A budget of 0 disables the watchdog, which restores all work.
+void configure(int64_t budget_us);
+
+namespace detail {
+
+auto end_window() -> bool;
+void restore_all();
+
+} /* namespace detail */
+
+// Adds its lifetime to the current hook call. Costs a single relaxed load
+// while the watchdog is disabled. Only use on the camera hook thread.
+class Scope {
+public:
+    Scope() : start(is_enabled() ? __rdtsc() : 0) {}
+    ~Scope() {
+        if (this->start == 0) [[likely]] return;
+        auto& hook = hot::g_hook;
+        auto const ticks = hook.call_ticks + (__rdtsc() - this->start);
+        hook.call_ticks = static_cast<uint32_t>(std::min<uint64_t>(ticks, std::numeric_limits<uint32_t>::max()));
+    }
+    Scope(Scope const&) = delete;
+    auto operator=(Scope const&) -> Scope& = delete;
+
+private:
+    uint64_t start;
+};
+
+// Ends a hook call after its scopes. Returns whether the update hook should
+// go dormant now.
+inline
+auto end_call() -> bool {
+    auto& hook = hot::g_hook;
+    if (!is_enabled()) [[likely]] {
+        if (hook.shed_level != 0) [[unlikely]] detail::restore_all();
+        return false;
+    }
+    hook.window_overruns += hook.budget_ticks != 0 && hook.call_ticks > hook.budget_ticks;
+    hook.call_ticks = 0;
+    if (++hook.window_calls < window_calls) return false;
+    return detail::end_window();
+}
+
+} /* namespace watchdog */
+
+#endif /* include guard */
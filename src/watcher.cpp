@@ -0,0 +1,123 @@
+#include "watcher.hpp"
+
+#include "config.hpp"
+#include "shared.hpp"
+#include "worker.hpp"
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+
+namespace watcher {
+
+namespace /* unnamed */ {
+
+// Editors usually write a file several times when saving it, so wait until
+// no changes have been made for a while before parsing it.
+constexpr auto debounce_ms = DWORD {100};
+
+auto g_thread = worker::Thread {};
+auto g_change_handle = INVALID_HANDLE_VALUE;
+
+// Only polls while the hooks hand it over or the watcher has failed, so it
+// wakes up rarely otherwise.
+constexpr auto poll_ms = DWORD {500};
+
+auto g_poll_thread = worker::Thread {};
+auto g_polling = std::atomic<bool> {false};
+
+enum class Event { Stop, Change, Timeout, Error };
+
+auto wait_for_event(HANDLE stop_event, DWORD timeout_ms) -> Event {
+    auto const handles = std::to_array({stop_event, g_change_handle});
+    switch (WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout_ms)) {
+        case WAIT_OBJECT_0: return Event::Stop;
+        case WAIT_OBJECT_0 + 1: return Event::Change;
+        case WAIT_TIMEOUT: return Event::Timeout;
+    }
+    return Event::Error;
+}
+
+auto wait_for_settled_change(HANDLE stop_event) -> Event {
+    auto event = wait_for_event(stop_event, INFINITE);
+    while (event == Event::Change) {
+        if (!FindNextChangeNotification(g_change_handle)) return Event::Error;
+        event = wait_for_event(stop_event, debounce_ms);
+    }
+    return event;
+}
+
+void poll(HANDLE stop_event) {
+    while (WaitForSingleObject(stop_event, poll_ms) == WAIT_TIMEOUT) {
+        if (g_polling.load(std::memory_order_relaxed)) config::load_config();
+    }
+}
+
+// The hooks no longer reload once the watcher has taken over, so the poller
+// has to keep loading changes if watching fails.
+void fall_back_to_polling() {
+    LOGLINE(ERR) << "Config watcher failed (error " << GetLastError() << "), polling config file instead.";
+    FindCloseChangeNotification(g_change_handle);
+    g_change_handle = INVALID_HANDLE_VALUE;
+    g_polling.store(true, std::memory_order_relaxed);
+    if (!g_poll_thread.start("config poller", poll)) {
+        LOGLINE(ERR) << "Changes to the config file will no longer be loaded!";
+    }
+}
+
+void watch(HANDLE stop_event) {
+    config::load_config();
+    while (true) {
+        switch (wait_for_settled_change(stop_event)) {
+            case Event::Timeout:
+                config::load_config();
+                break;
+            case Event::Error:
+                fall_back_to_polling();
+                return;
+            case Event::Stop:
+            case Event::Change:
+                return;
+        }
+    }
+}
+
+} /* unnamed namespace */
+
+auto start() -> bool {
+    auto const path = config::get_config_path();
+    if (!path.has_value()) return false;
+    auto const directory = std::filesystem::path {*path}.parent_path();
+    g_change_handle = FindFirstChangeNotificationW(directory.wstring().c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (g_change_handle == INVALID_HANDLE_VALUE) {
+        LOGLINE(WARN) << "Failed to watch '" << directory.string() << "' for changes, polling config file instead.";
+        g_poll_thread.start("config poller", poll);
+        return false;
+    }
+    if (!g_thread.start("config watcher", watch)) {
+        FindCloseChangeNotification(g_change_handle);
+        g_change_handle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    config::enable_background_reload();
+    return true;
+}
+
+void stop() {
+    // The watcher starts the poller if it fails, so stop it first.
+    g_thread.stop();
+    g_polling.store(false, std::memory_order_relaxed);
+    g_poll_thread.stop();
+    if (g_thread.is_running() || g_change_handle == INVALID_HANDLE_VALUE) return;
+    FindCloseChangeNotification(g_change_handle);
+    g_change_handle = INVALID_HANDLE_VALUE;
+}
+
+auto set_background_polling(bool enabled) -> bool {
+    if (enabled && !g_poll_thread.is_running()) return false;
+    g_polling.store(enabled, std::memory_order_relaxed);
+    return true;
+}
+
+} /* namespace watcher */
@@ -0,0 +1,18 @@
+#ifndef MHWORLD_CUSTOM_FOV_WATCHER_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_WATCHER_HPP_INCLUDED
+
+namespace watcher {
+
+// Watch the plugins directory on a background thread and reload the config
+// file when it changes. If this fails, the camera hooks poll the file instead,
+// and a background thread stands by to take over polling from them.
+auto start() -> bool;
+void stop();
+
+// Moves polling the config file to the standby thread, or back to the hooks.
+// Returns false if there is no standby thread to poll from.
+auto set_background_polling(bool enabled) -> bool;
+
+} /* namespace watcher */
+
+#endif /* include guard */
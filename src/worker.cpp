@@ -0,0 +1,72 @@
+#include "worker.hpp"
+
+#include "shared.hpp"
+
+namespace worker {
+
+namespace /* unnamed */ {
+
+constexpr auto stop_timeout_ms = DWORD {1000};
+
+void close_handle(HANDLE& handle) {
+    if (handle != nullptr) CloseHandle(handle);
+    handle = nullptr;
+}
+
+} /* unnamed namespace */
+
+auto WINAPI Thread::thread_proc(LPVOID parameter) -> DWORD {
+    auto const& self = *static_cast<Thread const*>(parameter);
+    auto const module = self.module;
+    self.function(self.stop_event);
+    // The thread handle cannot be waited on from DllMain, since exiting the
+    // thread requires the loader lock. Signal completion explicitly instead.
+    // Past this point stop() may return, so nothing but the module reference
+    // may be used.
+    SetEvent(self.done_event);
+    FreeLibraryAndExitThread(module, 0);
+}
+
+auto Thread::start(string_view name, Function function) -> bool {
+    if (this->thread != nullptr) return true;
+    this->name = name;
+    this->function = function;
+    this->stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    this->done_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    auto const referenced = GetModuleHandleExW(
+        GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&thread_proc), &this->module
+    );
+    if (referenced && this->stop_event != nullptr && this->done_event != nullptr) {
+        this->thread = CreateThread(nullptr, 0, thread_proc, this, 0, nullptr);
+    }
+    if (this->thread == nullptr) {
+        LOGLINE(ERR) << "Failed to start " << name << " thread (error " << GetLastError() << ")!";
+        if (referenced) FreeLibrary(this->module);
+        this->module = nullptr;
+        close_handle(this->stop_event);
+        close_handle(this->done_event);
+        return false;
+    }
+    return true;
+}
+
+void Thread::stop() {
+    if (this->thread == nullptr) return;
+    SetEvent(this->stop_event);
+    // On process termination the thread has already been killed.
+    auto const terminated = WaitForSingleObject(this->thread, 0) == WAIT_OBJECT_0;
+    if (!terminated && WaitForSingleObject(this->done_event, stop_timeout_ms) != WAIT_OBJECT_0) {
+        LOGLINE(WARN) << "Timed out waiting for " << this->name << " thread to stop.";
+        return; // leak the handles, the thread may still be using them
+    }
+    close_handle(this->thread);
+    close_handle(this->stop_event);
+    close_handle(this->done_event);
+    this->module = nullptr;
+}
+
+auto Thread::is_running() const -> bool {
+    return this->thread != nullptr;
+}
+
+} /* namespace worker */
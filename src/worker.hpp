@@ -0,0 +1,37 @@
+#ifndef MHWORLD_CUSTOM_FOV_WORKER_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_WORKER_HPP_INCLUDED
+
+#include "shared.hpp"
+
+namespace worker {
+
+// Background thread with a manual-reset stop event. The thread function
+// should return promptly once the stop event is signaled. The thread holds a
+// reference to the plugin until it exits, so its last instructions never run
+// from an unmapped image.
+class Thread {
+public:
+    using Function = void (*)(HANDLE stop_event);
+
+    Thread() = default;
+    Thread(Thread const&) = delete;
+    auto operator=(Thread const&) -> Thread& = delete;
+
+    auto start(string_view name, Function function) -> bool;
+    void stop();
+    auto is_running() const -> bool;
+
+private:
+    static auto WINAPI thread_proc(LPVOID parameter) -> DWORD;
+
+    string_view name = {};
+    Function function = nullptr;
+    HMODULE module = nullptr;
+    HANDLE thread = nullptr;
+    HANDLE stop_event = nullptr;
+    HANDLE done_event = nullptr;
+};
+
+} /* namespace worker */
+
+#endif /* include guard */
@@ -0,0 +1,29 @@
+#include "zones.hpp"
+
+#include "shared.hpp"
+
+namespace zones {
+
+#if defined(CUSTOMFOV_ETW)
+
+// {4eaf414b-00e7-4035-8c7b-db7c86db81a2}
+TRACELOGGING_DEFINE_PROVIDER(g_provider, "CustomFOV",
+    (0x4eaf414b, 0x00e7, 0x4035, 0x8c, 0x7b, 0xdb, 0x7c, 0x86, 0xdb, 0x81, 0xa2));
+
+void start() {
+    auto const result = TraceLoggingRegister(g_provider);
+    if (result != ERROR_SUCCESS) LOGLINE(WARN) << "Failed to register ETW provider (error " << result << ").";
+}
+
+void stop() {
+    TraceLoggingUnregister(g_provider);
+}
+
+#else
+
+void start() {}
+void stop() {}
+
+#endif
+
+} /* namespace zones */
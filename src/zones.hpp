@@ -0,0 +1,74 @@
+#ifndef MHWORLD_CUSTOM_FOV_ZONES_HPP_INCLUDED
+#define MHWORLD_CUSTOM_FOV_ZONES_HPP_INCLUDED
+
+// Named timeline zones for external profilers, next to the game's frames.
+// Both backends are compile time options, and ZONE expands to nothing
+// without them:
+// - CUSTOMFOV_TRACY emits Tracy zones. Add Tracy's public directory to the
+//   include path and TracyClient.cpp to the build.
+// - CUSTOMFOV_ETW registers the TraceLogging provider "CustomFOV" and
+//   writes start/stop events, only while a trace session enables it.
+
+#if defined(CUSTOMFOV_TRACY)
+#include "tracy/Tracy.hpp"
+#endif
+
+#if defined(CUSTOMFOV_ETW)
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+#endif
+
+namespace zones {
+
+// Registers and unregisters the ETW provider, if compiled in.
+void start();
+void stop();
+
+#if defined(CUSTOMFOV_ETW)
+
+TRACELOGGING_DECLARE_PROVIDER(g_provider);
+
+// The name must outlive the zone.
+class EtwZone {
+public:
+    explicit EtwZone(char const* name) : name(TraceLoggingProviderEnabled(g_provider, 0, 0) ? name : nullptr) {
+        if (this->name == nullptr) [[likely]] return;
+        TraceLoggingWrite(g_provider, "Zone", TraceLoggingOpcode(WINEVENT_OPCODE_START),
+            TraceLoggingString(this->name, "Name"));
+    }
+    ~EtwZone() {
+        if (this->name == nullptr) [[likely]] return;
+        TraceLoggingWrite(g_provider, "Zone", TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+            TraceLoggingString(this->name, "Name"));
+    }
+    EtwZone(EtwZone const&) = delete;
+    auto operator=(EtwZone const&) -> EtwZone& = delete;
+
+private:
+    char const* name;
+};
+
+#endif
+
+} /* namespace zones */
+
+#define ZONE_CONCAT_INNER(a, b) a##b
+#define ZONE_CONCAT(a, b) ZONE_CONCAT_INNER(a, b)
+
+#if defined(CUSTOMFOV_TRACY)
+#define ZONE_TRACY(name) ZoneScopedN(name)
+#else
+#define ZONE_TRACY(name)
+#endif
+
+#if defined(CUSTOMFOV_ETW)
+#define ZONE_ETW(name) auto const ZONE_CONCAT(etw_zone_, __LINE__) = zones::EtwZone {name}
+#else
+#define ZONE_ETW(name)
+#endif
+
+// Marks the rest of the enclosing scope, name must be a string literal.
+#define ZONE(name) ZONE_TRACY(name); ZONE_ETW(name)
+
+#endif /* include guard */